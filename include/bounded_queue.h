@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+// Lock-free bounded queue for multiple producers and consumers (D. Vyukov). Every cell carries a sequence number,
+// which tells producers and consumers whose turn it is, so a push or pop only needs one compare and swap. The
+// capacity is rounded up to the next power of two
+template<typename T>
+class bounded_queue final {
+   public:
+    using size_type = size_t;
+
+    explicit bounded_queue(size_type capacity);
+    bounded_queue(const bounded_queue &other) = delete;
+    bounded_queue(bounded_queue &&other) = delete;
+
+    bounded_queue &operator=(const bounded_queue &other) = delete;
+    bounded_queue &operator=(bounded_queue &&other) = delete;
+
+    // Returns false if the queue is full, the value isn't moved from in that case
+    bool try_push(T &&value);
+    bool try_push(const T &value);
+    std::optional<T> try_pop();
+
+    size_type capacity() const;
+    // Only an estimate, while other threads are pushing or popping
+    size_type size_approx() const;
+
+   private:
+    struct cell {
+        std::atomic<size_type> m_sequence;
+        std::optional<T> m_value;
+    };
+
+    template<typename U>
+    bool push_value(U &&value);
+
+    static size_type round_up_capacity(size_type capacity);
+
+    const size_type m_mask;
+    std::unique_ptr<cell[]> m_cells;
+    // Producers and consumers work on different cache lines
+    alignas(64) std::atomic<size_type> m_push_position{0};
+    alignas(64) std::atomic<size_type> m_pop_position{0};
+};
+
+template<typename T>
+bounded_queue<T>::bounded_queue(size_type capacity)
+    : m_mask(round_up_capacity(capacity) - 1), m_cells(new cell[m_mask + 1]) {
+    for (size_type i = 0; i <= m_mask; ++i) {
+        m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+bool bounded_queue<T>::try_push(T &&value) {
+    return push_value(std::move(value));
+}
+
+template<typename T>
+bool bounded_queue<T>::try_push(const T &value) {
+    return push_value(value);
+}
+
+template<typename T>
+template<typename U>
+bool bounded_queue<T>::push_value(U &&value) {
+    size_type position = m_push_position.load(std::memory_order_relaxed);
+    cell *current_cell = nullptr;
+
+    while (true) {
+        current_cell = &m_cells[position & m_mask];
+        size_type sequence = current_cell->m_sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if (difference == 0) {
+            if (m_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = m_push_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    current_cell->m_value.emplace(std::forward<U>(value));
+    current_cell->m_sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+std::optional<T> bounded_queue<T>::try_pop() {
+    size_type position = m_pop_position.load(std::memory_order_relaxed);
+    cell *current_cell = nullptr;
+
+    while (true) {
+        current_cell = &m_cells[position & m_mask];
+        size_type sequence = current_cell->m_sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if (difference == 0) {
+            if (m_pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return {};
+        } else {
+            position = m_pop_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::optional<T> result = std::move(current_cell->m_value);
+    current_cell->m_value.reset();
+    current_cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+    return result;
+}
+
+template<typename T>
+auto bounded_queue<T>::capacity() const -> size_type {
+    return m_mask + 1;
+}
+
+template<typename T>
+auto bounded_queue<T>::size_approx() const -> size_type {
+    size_type push_position = m_push_position.load(std::memory_order_relaxed);
+    size_type pop_position = m_pop_position.load(std::memory_order_relaxed);
+
+    return push_position > pop_position ? push_position - pop_position : 0;
+}
+
+template<typename T>
+auto bounded_queue<T>::round_up_capacity(size_type capacity) -> size_type {
+    size_type rounded_capacity = 2;
+
+    while (rounded_capacity < capacity) {
+        rounded_capacity <<= 1;
+    }
+
+    return rounded_capacity;
+}
@@ -9,6 +9,7 @@
 
 #include "gui/page_interface.h"
 #include "gui/single_output_view.h"
+#include "io/outputs/output_change_bus.h"
 
 class manual_control_view final : public page_interface {
    public:
@@ -28,6 +29,8 @@ class manual_control_view final : public page_interface {
 
     lv_obj_t *m_container = nullptr;
     std::vector<single_output_view> m_manual_overrides;
+    // The views are only updated, when an output actually changed
+    std::shared_ptr<output_change_subscription> m_output_changes;
     lv_obj_t *m_page = nullptr;
 
     friend class manual_control_view_controller;
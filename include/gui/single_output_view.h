@@ -5,6 +5,7 @@
 
 #include "lvgl.h"
 
+#include "io/outputs/output_value.h"
 #include "value_storage.h"
 
 struct single_output_element_storage final {
@@ -25,7 +26,9 @@ class single_output_view final {
     ~single_output_view() = default;
 
     lv_obj_t *container();
+    const std::string &output_id() const;
     void update_gui();
+    void show_value(const output_value &value);
 
    private:
     void create_gui(lv_obj_t *parent);
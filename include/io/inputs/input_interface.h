@@ -1,31 +1,66 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "nlohmann/json.hpp"
+
+#include "io/outputs/output_value.h"
 #include "pattern_templates/singleton.h"
 
 using json = nlohmann::json;
 
+// Inputs use the same value types as the outputs, e.g. a switch_output for a float switch
+struct input_event {
+    output_value m_value;
+    // Point in time of the change, as reported by the interface (e.g. the kernel timestamp of a gpio edge)
+    std::chrono::nanoseconds m_timestamp;
+};
+
 class input_interface {
    public:
+    using event_callback = std::function<void(const input_event &event)>;
+
     input_interface() = default;
     virtual ~input_interface() = default;
 
-    void read_value();
+    virtual std::optional<output_value> read_value() const = 0;
+
+    // Called with every change of the input, has to be set before the input is used
+    void on_event(event_callback callback);
+
+   protected:
+    void notify(const input_event &event) const;
+
+   private:
+    event_callback m_on_event;
 };
 
 class input_factory : public singleton<input_factory> {
    public:
     using factory_func = std::function<std::unique_ptr<input_interface>(const json &description)>;
+
     static std::shared_ptr<input_factory> instance();
-    static std::unique_ptr<input_factory> deserialize(const std::string &type, const json &description);
+    static std::unique_ptr<input_interface> deserialize(const std::string &type, const json &description);
     template<typename T>
     static bool register_interface(const std::string &type, T func);
 
    private:
     std::map<std::string, factory_func> m_factories;
 };
+
+template<typename T>
+bool input_factory::register_interface(const std::string &type, T func) {
+    auto lock = retrieve_instance_lock();
+    auto factory_instance = instance();
+
+    if (!factory_instance) {
+        return false;
+    }
+
+    return factory_instance->m_factories.try_emplace(type, func).second;
+}
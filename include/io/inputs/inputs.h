@@ -1,6 +1,40 @@
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "io/inputs/input_interface.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+using input_id = std::string;
+
 class inputs {
    public:
+    using listener = std::function<void(const input_id &id, const input_event &event)>;
+
+    static bool is_valid_id(const input_id &id);
+    static std::optional<output_value> read_value(const input_id &id);
+    static std::vector<input_id> get_ids();
+    // Listeners are called by the thread, which detected the event, so they shouldn't block
+    static void add_listener(listener new_listener);
+
    private:
+    static bool add_input(json &input_description);
+    static void dispatch_event(const input_id &id, const input_event &event);
+
+    // The list is only modified while the inputs are loaded
+    static inline std::map<input_id, std::unique_ptr<input_interface>> _inputs;
+    static inline std::shared_mutex _list_mutex;
+    static inline std::vector<listener> _listeners;
+    static inline std::mutex _listeners_mutex;
+
+    friend class schedule;
 };
@@ -1,42 +1,132 @@
 #pragma once
+#include <linux/can.h>
 #include <unistd.h>
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include "io/interfaces/io_event_loop.h"
 #include "io/outputs/output_interface.h"
 #include "logger.h"
+#include "ring_buffer.h"
 
 enum struct can_object_identifier : uint16_t {};
 
 enum struct can_error_code { ok = 0, send_error = 1, receive_error };
 
-// TODO: map of can instances, since there can be multiple can devices simultaniously
+// Queued frames of an identifier are replaced by newer ones, unless every frame matters (e.g. segmented transfers).
+// Frames, which are sent in order, are never replaced
+enum struct can_send_mode { coalesce, in_order };
+
+struct can_message {
+    can_object_identifier m_identifier;
+    uint8_t m_length = 0;
+    std::array<uint8_t, 64> m_data{};
+    std::chrono::system_clock::time_point m_timestamp{};
+};
+
+// One non-blocking raw socket per can interface, the sockets of all interfaces are serviced by the io_event_loop.
+// Frames, which don't fit into the socket buffer, are queued and written, when the socket is writable again. The queue
+// is ordered by the priority of the identifiers and only keeps the newest payload of an identifier. The kernel
+// only delivers frames with identifiers, which somebody is interested in, the last frames of each of those identifiers
+// are kept
 class can final {
    public:
-    static inline constexpr char default_can_path[] = "/dev/can0";
+    using receive_callback = std::function<void(const can_message &message)>;
+
+    static inline constexpr char default_can_interface[] = "can0";
 
-    static std::shared_ptr<can> instance(const std::filesystem::path &can_path = default_can_path);
+    // The interface is identified by its name (can0, vcan1), for a path the last component is used
+    static std::shared_ptr<can> instance(const std::filesystem::path &can_interface = default_can_interface);
 
-    can(can &&other) = default;
+    can(can &&other) = delete;
     can(const can &other) = delete;
     ~can();
 
     can &operator=(const can &other) = delete;
-    can &operator=(can &&other) = default;
+    can &operator=(can &&other) = delete;
 
-    const std::filesystem::path &path_to_file() const;
+    const std::string &interface_name() const;
 
-    // TODO: Allow different packet size
+    // Sends the 8 bytes of the data in a classic frame
     can_error_code send(const can_object_identifier &identifier, uint64_t data);
-    can_error_code receive(const can_object_identifier &identifier, uint64_t *data);
+    can_error_code send(const can_message &message, can_send_mode mode = can_send_mode::coalesce);
+    // Sends the messages in order with as few system calls as possible, payloads longer than 8 bytes are sent as can
+    // fd frames, if the interface supports them. Returns the result for every message
+    std::vector<can_error_code> send(const std::vector<can_message> &messages,
+                                     can_send_mode mode = can_send_mode::coalesce);
+    bool supports_fd_frames() const;
+    // Number of queued frames, which were replaced by a newer payload of their identifier
+    size_t coalesced_frames() const;
+
+    // Starts receiving frames with this identifier, the frames are kept in a ring buffer
+    bool receive_from(const can_object_identifier &identifier);
+    // Copies the payload of the last received frame of the identifier
+    can_error_code receive(const can_object_identifier &identifier, uint64_t *data) const;
+    std::optional<can_message> last_message(const can_object_identifier &identifier) const;
+    // Oldest message first
+    std::vector<can_message> received_messages(const can_object_identifier &identifier) const;
+
+    // Also starts receiving from the identifier, the callbacks are called by the thread of the io_event_loop, so they
+    // shouldn't block
+    bool add_receive_listener(const can_object_identifier &identifier, receive_callback callback);
 
    private:
-    static inline std::shared_ptr<can> _instance = nullptr;
-    static inline std::mutex _instance_mutex{};
+    can(std::string interface_name, int socket_handle, int retry_timer_fd, bool supports_fd_frames);
+
+    std::optional<canfd_frame> frame_of(const can_message &message) const;
 
-    can(int socket_handle);
+    void handle_events(uint32_t events);
+    void read_frames();
+    // Has to be called with the receive mutex held
+    bool update_receive_filter();
+    void write_pending_frames();
+    void retry_time_passed();
+    // Waits for writability and arms the retry timer, while frames are queued, has to be called with the pending
+    // frames mutex held
+    void wait_for_writability();
+    // Writes the frames with sendmmsg without blocking, until the socket buffer is full. Returns the number of frames,
+    // which were handled, the results of these frames are stored in results
+    size_t write_frames(const canfd_frame *frames, size_t number_of_frames, can_error_code *results);
 
+    static inline std::map<std::string, std::shared_ptr<can>> _instances{};
+    static inline std::mutex _instance_mutex{};
+
+    const std::string m_interface_name;
     int m_socket_handle = -1;
+    int m_retry_timer_fd = -1;
+    const bool m_supports_fd_frames = false;
+    std::shared_ptr<io_event_loop> m_event_loop;
+
+    struct pending_frame {
+        canfd_frame m_frame;
+        can_send_mode m_mode;
+    };
+
+    // Lower identifiers win the arbitration on the bus, so they are sent first
+    std::map<canid_t, std::deque<pending_frame>> m_pending_frames;
+    size_t m_number_of_pending_frames = 0;
+    size_t m_coalesced_frames = 0;
+    mutable std::mutex m_pending_frames_mutex;
+
+    static inline constexpr size_t _received_messages_per_identifier = 16;
+
+    std::multimap<can_object_identifier, receive_callback> m_receive_listeners;
+    std::map<can_object_identifier, ring_buffer<can_message, _received_messages_per_identifier>> m_received_messages;
+    mutable std::mutex m_receive_mutex;
+
+    static inline constexpr size_t _max_pending_frames = 256;
+    // Upper bound of the frames handed to the kernel with one sendmmsg
+    static inline constexpr size_t _max_frames_per_write = 64;
+    static inline constexpr std::chrono::milliseconds _retry_interval{5};
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "io/interfaces/can/can.h"
+#include "io/interfaces/can/isotp_transfer.h"
+#include "io/interfaces/io_event_loop.h"
+
+// Sends segmented payloads to one can node. The frames are sent with the transmit identifier, the node answers with
+// flow control frames on the flow control identifier. Only the first frame is sent by the caller, the rest of the
+// transfer is driven by the io_event_loop, so sending never blocks
+class can_transport final {
+   public:
+    using completion_callback = std::function<void(bool is_delivered)>;
+
+    static std::shared_ptr<can_transport> create(std::shared_ptr<can> can_instance,
+                                                 can_object_identifier transmit_identifier,
+                                                 can_object_identifier flow_control_identifier);
+
+    can_transport(const can_transport &other) = delete;
+    can_transport(can_transport &&other) = delete;
+    ~can_transport();
+
+    can_transport &operator=(const can_transport &other) = delete;
+    can_transport &operator=(can_transport &&other) = delete;
+
+    // If a transfer is running, the payload is sent after it, a payload, which is waiting as well, is replaced. The
+    // result is available, when the transfer of the payload is finished, the results of replaced payloads are the
+    // result of the payload, which replaced them
+    std::future<bool> send(std::vector<uint8_t> payload);
+    bool is_busy() const;
+    // Called by the thread of the io_event_loop or the sender, it mustn't call send
+    void on_transfer_finished(completion_callback callback);
+
+   private:
+    struct pending_payload {
+        std::vector<uint8_t> m_payload;
+        std::vector<std::promise<bool>> m_results;
+    };
+
+    can_transport(std::shared_ptr<can> can_instance, can_object_identifier transmit_identifier, int timer_fd);
+
+    void handle_flow_control(const can_message &message);
+    void timer_expired();
+
+    // These have to be called with the transfer mutex held
+    void start_next_transfer();
+    void continue_transfer();
+    void finish_transfer();
+    bool send_frames(const std::vector<can_message> &frames);
+    void arm_timer(std::chrono::microseconds timeout);
+
+    std::shared_ptr<can> m_can_instance;
+    const can_object_identifier m_transmit_identifier;
+    const int m_timer_fd;
+    std::shared_ptr<io_event_loop> m_event_loop;
+
+    std::optional<isotp_transfer> m_transfer;
+    std::vector<std::promise<bool>> m_transfer_results;
+    std::optional<pending_payload> m_next_payload;
+    completion_callback m_on_transfer_finished;
+    mutable std::mutex m_transfer_mutex;
+
+    // How long the receiver has to answer a first frame or a finished block (N_Bs)
+    static inline constexpr std::chrono::milliseconds _flow_control_timeout{1000};
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "io/interfaces/can/can.h"
+
+// Segments one payload into the single, first and consecutive frames of ISO 15765-2 (iso-tp) with classic 8 byte
+// frames. The transfer doesn't do any io, it only tells which frames are due, so it can be driven by any event loop
+class isotp_transfer final {
+   public:
+    enum struct transfer_state { sending, waiting_for_flow_control, finished, failed };
+
+    static inline constexpr size_t max_payload_size = 4095;
+
+    isotp_transfer(can_object_identifier identifier, std::vector<uint8_t> payload);
+
+    // The single frame or the first frame of the transfer, this starts the transfer
+    can_message start();
+    void handle_flow_control(const can_message &message);
+    // The consecutive frames, which can be sent right now. Without a separation time that is the whole block,
+    // otherwise the separation time has to pass between the frames
+    std::vector<can_message> next_frames();
+    // Marks the transfer as failed, e.g. if the receiver didn't answer in time
+    void abort();
+
+    transfer_state state() const;
+    std::chrono::microseconds separation_time() const;
+
+   private:
+    can_message consecutive_frame();
+
+    static std::chrono::microseconds parse_separation_time(uint8_t separation_time);
+
+    const can_object_identifier m_identifier;
+    const std::vector<uint8_t> m_payload;
+    transfer_state m_state = transfer_state::sending;
+    size_t m_sent_bytes = 0;
+    uint8_t m_sequence_number = 1;
+    // Zero means, that the receiver doesn't want to send any more flow control frames
+    uint8_t m_block_size = 0;
+    uint8_t m_frames_left_in_block = 0;
+    unsigned int m_received_wait_frames = 0;
+    std::chrono::microseconds m_separation_time{0};
+
+    static inline constexpr size_t _frame_size = 8;
+    static inline constexpr unsigned int _max_wait_frames = 16;
+};
@@ -7,6 +7,8 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "io/interfaces/gpio/gpio_pin.h"
 #include "io/interfaces/gpio/gpiod_wrapper.h"
@@ -41,13 +43,53 @@ class gpio_chip final : public rest_resource<gpio_chip>, std::enable_shared_from
 
     gpio_chip(const std::filesystem::path &gpio_dev, gpiod::gpiod_chip chip);
 
+    // The chip owns all the output lines. Every line is requested on its own, so adding or releasing a line never
+    // touches the other lines. Lines, which are switched together, are merged into one request, when a batch writes all
+    // the lines of their requests, from then on they are switched with one call. The returned index identifies the
+    // line in the calls below, until the line is released
+    std::optional<size_t> request_output_line(unsigned int offset, int flags);
+    void release_output_line(size_t index);
+    bool set_output_values(const std::vector<std::pair<size_t, int>> &values);
+    std::optional<int> output_line_value(size_t index) const;
+
+    struct output_line {
+        unsigned int m_offset;
+        gpiod::gpiod_line m_line;
+        // The last value written to the line, a request is always written as a whole
+        int m_value;
+        // Lines without a request can't be written
+        std::optional<size_t> m_request;
+        // Released lines stay requested, until all the lines of their request are released
+        bool m_is_used;
+    };
+
+    struct output_request {
+        gpiod::gpiod_line_bulk m_bulk;
+        // The index of every line of the request in the order of the bulk
+        std::vector<size_t> m_indices;
+        int m_flags;
+    };
+
+    // These have to be called with the output mutex held
+    std::optional<size_t> add_output_request(const std::vector<size_t> &indices, const std::vector<int> &values,
+                                             int flags);
+    void remove_output_request(size_t request_index);
+    bool merge_output_requests(const std::vector<size_t> &request_indices, const std::map<size_t, int> &values);
+    bool write_output_request(size_t request_index, const std::map<size_t, int> &values);
+
     std::filesystem::path m_gpiochip_path;
     std::map<gpio_pin_id, std::shared_ptr<gpio_pin>> m_reserved_pins;
     gpiod::gpiod_chip m_chip;
+    // Entries are never removed, so the indices of the lines stay valid
+    std::vector<output_line> m_output_line_entries;
+    // Removed requests leave an empty entry, so the indices of the other requests stay valid
+    std::vector<std::optional<output_request>> m_output_requests;
+    mutable std::mutex m_output_mutex;
 
     static inline std::recursive_mutex _instance_mutex;
     static inline std::map<std::filesystem::path, std::shared_ptr<gpio_chip>> _gpiochip_access_map;
 
     friend class gpio_handler;
+    friend class gpio_input;
     friend class gpio_pin;
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include "io/inputs/input_interface.h"
+#include "io/interfaces/gpio/gpiod_wrapper.h"
+#include "io/outputs/output_value.h"
+
+class gpio_chip;
+
+// Input line of a gpio chip, the edges of the line are read by the io_event_loop. An edge is only reported, if the line
+// keeps its new level for the debounce time, the reported timestamp is the kernel timestamp of that edge
+class gpio_input final : public input_interface {
+   public:
+    gpio_input(const gpio_input &other) = delete;
+    gpio_input(gpio_input &&other) = delete;
+    virtual ~gpio_input();
+
+    gpio_input &operator=(const gpio_input &other) = delete;
+    gpio_input &operator=(gpio_input &&other) = delete;
+
+    virtual std::optional<output_value> read_value() const override;
+
+    static std::unique_ptr<input_interface> create_for_interface(const nlohmann::json &description);
+
+   private:
+    gpio_input(std::shared_ptr<gpio_chip> chip_instance, unsigned int pin, gpiod::gpiod_line line, int timer_fd,
+               std::chrono::milliseconds debounce_time);
+
+    void read_line_events();
+    void debounce_time_passed();
+    void accept_pending_value();
+
+    std::shared_ptr<gpio_chip> m_gpiochip_instance;
+    const unsigned int m_pin;
+    gpiod::gpiod_line m_line;
+    const int m_timer_fd;
+    const std::chrono::milliseconds m_debounce_time;
+    // The last edge, which isn't debounced yet, only used by the thread of the io_event_loop
+    int m_pending_value = 0;
+    std::chrono::nanoseconds m_pending_timestamp{0};
+    std::atomic<int> m_value{0};
+
+    static inline constexpr std::chrono::milliseconds _default_debounce_time{50};
+};
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "io/interfaces/gpio/gpiod_wrapper.h"
 #include "io/outputs/output_interface.h"
@@ -38,7 +39,7 @@ class gpio_pin final : public rest_resource<gpio_pin>, public output_interface {
    public:
     gpio_pin(gpio_pin &other) = delete;
     gpio_pin(gpio_pin &&other);
-    ~gpio_pin() = default;
+    ~gpio_pin();
 
     gpio_pin &operator=(gpio_pin &other) = delete;
     gpio_pin &operator=(gpio_pin &&other);
@@ -48,6 +49,9 @@ class gpio_pin final : public rest_resource<gpio_pin>, public output_interface {
     virtual bool restore_control() override;
     virtual std::optional<output_value> is_overriden() const override;
     virtual output_value current_state() const override;
+    // The pins of one chip are switched together
+    virtual const void *batch_driver() const override;
+    virtual std::vector<bool> control_outputs(const output_batch &batch) override;
 
     unsigned int gpio_id() const;
 
@@ -59,10 +63,13 @@ class gpio_pin final : public rest_resource<gpio_pin>, public output_interface {
     static std::optional<gpio_pin> open(std::shared_ptr<gpio_chip> chip_instance, gpio_pin_id id);
 
     bool update_gpio();
+    // The value of the line, which results from the controlled and the overriden value
+    std::optional<int> line_value_to_write(int current_line_value) const;
 
-    gpio_pin(std::weak_ptr<gpio_chip> chip_instance, gpio_pin_id id, gpiod::gpiod_line line);
+    gpio_pin(std::weak_ptr<gpio_chip> chip_instance, gpio_pin_id id, size_t line_index);
 
-    gpiod::gpiod_line m_line;
+    // The line itself is owned by the chip, the pin releases it through the chip
+    std::optional<size_t> m_line_index;
     switch_output m_controlled_value;
     std::optional<switch_output> m_overriden_value;
     std::weak_ptr<gpio_chip> m_gpiochip_instance;
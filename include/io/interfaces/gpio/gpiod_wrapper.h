@@ -2,13 +2,20 @@
 
 #include "gpiod.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <map>
 #include <mutex>
+#include <string>
+#include <vector>
 
 namespace gpiod {
 
     using native_gpiod_chip = ::gpiod_chip;
     using native_gpiod_line = ::gpiod_line;
+    using native_gpiod_line_event = ::gpiod_line_event;
 
     namespace detail {
 
@@ -26,6 +33,9 @@ namespace gpiod {
         template<typename T>
         class gpiod_line;
 
+        template<typename T>
+        class gpiod_line_bulk;
+
         template<>
         class gpiod_line<real> {
            public:
@@ -40,6 +50,10 @@ namespace gpiod {
             int get_value();
             int set_value(int value);
             int request_output_flags(const char *consumer, int flags, int default_val);
+            int request_both_edges_events_flags(const char *consumer, int flags);
+            // The file descriptor becomes readable, when an event of the line is available
+            int event_fd();
+            int read_event(native_gpiod_line_event *event);
 
             explicit operator bool() const;
 
@@ -54,6 +68,7 @@ namespace gpiod {
             native_gpiod_line *m_native = nullptr;
 
             friend class gpiod_chip<real>;
+            friend class gpiod_line_bulk<real>;
         };
 
         template<>
@@ -82,12 +97,42 @@ namespace gpiod {
             friend class gpiod_line<real>;
         };
 
+        // Lines which are requested together, so all of them can be read or set with one call. The lines are only
+        // referenced, they have to outlive the bulk
+        template<>
+        class gpiod_line_bulk<real> {
+           public:
+            gpiod_line_bulk();
+            gpiod_line_bulk(const gpiod_line_bulk<real> &other) = delete;
+            gpiod_line_bulk(gpiod_line_bulk<real> &&other);
+            ~gpiod_line_bulk();
+
+            gpiod_line_bulk &operator=(const gpiod_line_bulk<real> &other) = delete;
+            gpiod_line_bulk &operator=(gpiod_line_bulk<real> &&other);
+            void swap(gpiod_line_bulk<real> &other);
+
+            // Lines can only be added, while the bulk isn't requested
+            bool add(gpiod_line<real> &line);
+            int request_output_flags(const char *consumer, int flags, const int *default_vals);
+            int get_values(int *values);
+            int set_values(const int *values);
+            unsigned int size() const;
+
+            explicit operator bool() const;
+
+            void release_resource();
+
+           private:
+            ::gpiod_line_bulk m_native;
+            bool m_is_requested = false;
+        };
+
         template<>
         class gpiod_line<stub> {
            public:
             gpiod_line(const gpiod_line<stub> &other) = delete;
             gpiod_line(gpiod_line<stub> &&other);
-            ~gpiod_line() = default;
+            ~gpiod_line();
 
             gpiod_line &operator=(const gpiod_line<stub> &other) = delete;
             gpiod_line &operator=(gpiod_line<stub> &&other);
@@ -96,6 +141,13 @@ namespace gpiod {
             int get_value();
             int set_value(int value);
             int request_output_flags(const char *consumer, int flags, int default_val);
+            // The events are read from a pipe, the other end is written by inject_event
+            int request_both_edges_events_flags(const char *consumer, int flags);
+            int event_fd();
+            int read_event(native_gpiod_line_event *event);
+
+            // Simulates an edge of the line with the offset, if events of the line were requested
+            static bool inject_event(unsigned int offset, int event_type, timespec timestamp);
 
             explicit operator bool() const;
 
@@ -104,13 +156,21 @@ namespace gpiod {
            private:
             gpiod_line(gpiod_chip<stub> &chip, unsigned int offset);
 
+            void close_event_pipe();
+
             int m_offset = 0;
             int m_value = 0;
             int m_flags = 0;
             bool m_valid = false;
             std::string m_consumer = "";
+            int m_event_read_fd = -1;
+            int m_event_write_fd = -1;
+
+            static inline std::map<unsigned int, int> _event_writers;
+            static inline std::mutex _event_writers_mutex;
 
             friend class gpiod_chip<stub>;
+            friend class gpiod_line_bulk<stub>;
         };
 
         template<>
@@ -137,6 +197,39 @@ namespace gpiod {
             friend class gpiod_line<stub>;
         };
 
+        template<>
+        class gpiod_line_bulk<stub> {
+           public:
+            gpiod_line_bulk() = default;
+            gpiod_line_bulk(const gpiod_line_bulk<stub> &other) = delete;
+            gpiod_line_bulk(gpiod_line_bulk<stub> &&other) = default;
+            ~gpiod_line_bulk() = default;
+
+            gpiod_line_bulk &operator=(const gpiod_line_bulk<stub> &other) = delete;
+            gpiod_line_bulk &operator=(gpiod_line_bulk<stub> &&other) = default;
+            void swap(gpiod_line_bulk<stub> &other);
+
+            bool add(gpiod_line<stub> &line);
+            int request_output_flags(const char *consumer, int flags, const int *default_vals);
+            int get_values(int *values);
+            int set_values(const int *values);
+            unsigned int size() const;
+
+            explicit operator bool() const;
+
+            void release_resource();
+
+            // Simulates requests, which are refused, e.g. because another process uses one of the lines
+            static void fail_next_requests(unsigned int number_of_requests);
+
+           private:
+            std::vector<int> m_offsets;
+            std::vector<int> m_values;
+            bool m_is_requested = false;
+
+            static inline unsigned int _failing_requests = 0;
+        };
+
         inline gpiod_chip<real>::gpiod_chip(const char *path) : m_native(gpiod_chip_open(path)) {}
 
         inline gpiod_chip<real>::gpiod_chip(gpiod_chip<real> &&other) : m_native(other.m_native) {
@@ -205,6 +298,16 @@ namespace gpiod {
             return gpiod_line_request_output_flags(native(), consumer, flags, default_val);
         }
 
+        inline int gpiod_line<real>::request_both_edges_events_flags(const char *consumer, int flags) {
+            return gpiod_line_request_both_edges_events_flags(native(), consumer, flags);
+        }
+
+        inline int gpiod_line<real>::event_fd() { return gpiod_line_event_get_fd(native()); }
+
+        inline int gpiod_line<real>::read_event(native_gpiod_line_event *event) {
+            return gpiod_line_event_read_fd(event_fd(), event);
+        }
+
         inline gpiod_line<real>::operator bool() const { return m_native != nullptr; }
 
         inline void gpiod_line<real>::release_resource() {
@@ -220,6 +323,67 @@ namespace gpiod {
 
         inline const native_gpiod_line *gpiod_line<real>::native() const { return m_native; }
 
+        inline gpiod_line_bulk<real>::gpiod_line_bulk() { gpiod_line_bulk_init(&m_native); }
+
+        inline gpiod_line_bulk<real>::gpiod_line_bulk(gpiod_line_bulk<real> &&other)
+            : m_native(other.m_native), m_is_requested(other.m_is_requested) {
+            gpiod_line_bulk_init(&other.m_native);
+            other.m_is_requested = false;
+        }
+
+        inline gpiod_line_bulk<real>::~gpiod_line_bulk() { release_resource(); }
+
+        inline gpiod_line_bulk<real> &gpiod_line_bulk<real>::operator=(gpiod_line_bulk<real> &&other) {
+            gpiod_line_bulk<real> tmp(std::move(other));
+            swap(tmp);
+
+            return *this;
+        }
+
+        inline void gpiod_line_bulk<real>::swap(gpiod_line_bulk<real> &other) {
+            using std::swap;
+
+            swap(m_native, other.m_native);
+            swap(m_is_requested, other.m_is_requested);
+        }
+
+        inline bool gpiod_line_bulk<real>::add(gpiod_line<real> &line) {
+            if (m_is_requested || !line || m_native.num_lines >= GPIOD_LINE_BULK_MAX_LINES) {
+                return false;
+            }
+
+            gpiod_line_bulk_add(&m_native, line.native());
+            return true;
+        }
+
+        inline int gpiod_line_bulk<real>::request_output_flags(const char *consumer, int flags,
+                                                                const int *default_vals) {
+            int result = gpiod_line_request_bulk_output_flags(&m_native, consumer, flags, default_vals);
+            m_is_requested = result == 0;
+            return result;
+        }
+
+        inline int gpiod_line_bulk<real>::get_values(int *values) {
+            return gpiod_line_get_value_bulk(&m_native, values);
+        }
+
+        inline int gpiod_line_bulk<real>::set_values(const int *values) {
+            return gpiod_line_set_value_bulk(&m_native, values);
+        }
+
+        inline unsigned int gpiod_line_bulk<real>::size() const { return m_native.num_lines; }
+
+        inline gpiod_line_bulk<real>::operator bool() const { return m_is_requested; }
+
+        inline void gpiod_line_bulk<real>::release_resource() {
+            if (!m_is_requested) {
+                return;
+            }
+
+            gpiod_line_release_bulk(&m_native);
+            m_is_requested = false;
+        }
+
         inline gpiod_chip<stub>::gpiod_chip(const char *path) : m_path(path) {}
 
         inline void gpiod_chip<stub>::swap(gpiod_chip<stub> &other) {
@@ -244,14 +408,20 @@ namespace gpiod {
               m_value(other.m_value),
               m_flags(other.m_flags),
               m_valid(other.m_valid),
-              m_consumer(std::move(other.m_consumer)) {
+              m_consumer(std::move(other.m_consumer)),
+              m_event_read_fd(other.m_event_read_fd),
+              m_event_write_fd(other.m_event_write_fd) {
             other.m_offset = 0;
             other.m_value = 0;
             other.m_flags = 0;
             other.m_valid = false;
             other.m_consumer = "";
+            other.m_event_read_fd = -1;
+            other.m_event_write_fd = -1;
         }
 
+        inline gpiod_line<stub>::~gpiod_line() { close_event_pipe(); }
+
         inline gpiod_line<stub> &gpiod_line<stub>::operator=(gpiod_line<stub> &&other) {
             gpiod_line<stub> tmp(std::move(other));
             swap(tmp);
@@ -267,6 +437,8 @@ namespace gpiod {
             swap(m_flags, other.m_flags);
             swap(m_valid, other.m_valid);
             swap(m_consumer, other.m_consumer);
+            swap(m_event_read_fd, other.m_event_read_fd);
+            swap(m_event_write_fd, other.m_event_write_fd);
         }
 
         inline int gpiod_line<stub>::get_value() { return m_value; }
@@ -283,13 +455,134 @@ namespace gpiod {
             return 0;
         }
 
+        inline int gpiod_line<stub>::request_both_edges_events_flags(const char *consumer, int flags) {
+            int event_pipe[2];
+
+            if (m_event_read_fd != -1 || pipe(event_pipe) == -1) {
+                return -1;
+            }
+
+            m_consumer = consumer;
+            m_flags = flags;
+            m_event_read_fd = event_pipe[0];
+            m_event_write_fd = event_pipe[1];
+
+            std::lock_guard<std::mutex> writers_guard{_event_writers_mutex};
+            _event_writers[m_offset] = m_event_write_fd;
+            return 0;
+        }
+
+        inline int gpiod_line<stub>::event_fd() { return m_event_read_fd; }
+
+        inline int gpiod_line<stub>::read_event(native_gpiod_line_event *event) {
+            return read(m_event_read_fd, event, sizeof(*event)) == sizeof(*event) ? 0 : -1;
+        }
+
+        inline bool gpiod_line<stub>::inject_event(unsigned int offset, int event_type, timespec timestamp) {
+            std::lock_guard<std::mutex> writers_guard{_event_writers_mutex};
+
+            auto writer = _event_writers.find(offset);
+
+            if (writer == _event_writers.cend()) {
+                return false;
+            }
+
+            native_gpiod_line_event event{};
+            event.ts = timestamp;
+            event.event_type = event_type;
+
+            return write(writer->second, &event, sizeof(event)) == sizeof(event);
+        }
+
         inline gpiod_line<stub>::operator bool() const { return m_valid; }
 
-        inline void gpiod_line<stub>::release_resource() { m_valid = false; }
+        inline void gpiod_line<stub>::release_resource() {
+            m_valid = false;
+            close_event_pipe();
+        }
+
+        inline void gpiod_line<stub>::close_event_pipe() {
+            if (m_event_read_fd == -1) {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> writers_guard{_event_writers_mutex};
+
+                if (auto writer = _event_writers.find(m_offset);
+                    writer != _event_writers.cend() && writer->second == m_event_write_fd) {
+                    _event_writers.erase(writer);
+                }
+            }
+
+            close(m_event_read_fd);
+            close(m_event_write_fd);
+            m_event_read_fd = -1;
+            m_event_write_fd = -1;
+        }
+
+        inline void gpiod_line_bulk<stub>::swap(gpiod_line_bulk<stub> &other) {
+            using std::swap;
+
+            swap(m_offsets, other.m_offsets);
+            swap(m_values, other.m_values);
+            swap(m_is_requested, other.m_is_requested);
+        }
+
+        inline bool gpiod_line_bulk<stub>::add(gpiod_line<stub> &line) {
+            if (m_is_requested || !line || m_offsets.size() >= GPIOD_LINE_BULK_MAX_LINES) {
+                return false;
+            }
+
+            m_offsets.push_back(line.m_offset);
+            m_values.push_back(0);
+            return true;
+        }
+
+        inline int gpiod_line_bulk<stub>::request_output_flags(const char *consumer, int flags,
+                                                                const int *default_vals) {
+            if (_failing_requests > 0) {
+                --_failing_requests;
+                return -1;
+            }
+
+            std::copy(default_vals, default_vals + m_values.size(), m_values.begin());
+            m_is_requested = true;
+            return 0;
+        }
+
+        inline int gpiod_line_bulk<stub>::get_values(int *values) {
+            if (!m_is_requested) {
+                return -1;
+            }
+
+            std::copy(m_values.cbegin(), m_values.cend(), values);
+            return 0;
+        }
+
+        inline int gpiod_line_bulk<stub>::set_values(const int *values) {
+            if (!m_is_requested) {
+                return -1;
+            }
+
+            std::copy(values, values + m_values.size(), m_values.begin());
+            return 0;
+        }
+
+        inline unsigned int gpiod_line_bulk<stub>::size() const { return m_offsets.size(); }
+
+        inline gpiod_line_bulk<stub>::operator bool() const { return m_is_requested; }
+
+        inline void gpiod_line_bulk<stub>::release_resource() { m_is_requested = false; }
+
+        inline void gpiod_line_bulk<stub>::fail_next_requests(unsigned int number_of_requests) {
+            _failing_requests = number_of_requests;
+        }
 
     }  // namespace detail
 
     using gpiod_chip = detail::gpiod_chip<detail::type>;
     using gpiod_line = detail::gpiod_line<detail::type>;
+    using gpiod_line_bulk = detail::gpiod_line_bulk<detail::type>;
 
 }  // namespace gpiod
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "pattern_templates/singleton.h"
+
+// Waits for the events of all the watched file descriptors (gpio lines, sockets, timers) with one epoll thread. The
+// callbacks are called by this thread, so they shouldn't block. A callback can be called spuriously, e.g. if the file
+// descriptor was reused right after it was unwatched, so the file descriptors should be non-blocking
+class io_event_loop final {
+   public:
+    using event_callback = std::function<void(uint32_t events)>;
+
+    static std::shared_ptr<io_event_loop> instance();
+
+    io_event_loop(const io_event_loop &other) = delete;
+    io_event_loop(io_event_loop &&other) = delete;
+    ~io_event_loop();
+
+    io_event_loop &operator=(const io_event_loop &other) = delete;
+    io_event_loop &operator=(io_event_loop &&other) = delete;
+
+    // The events are the epoll events (EPOLLIN, EPOLLOUT, ...) the file descriptor is watched for
+    bool watch(int fd, uint32_t events, event_callback callback);
+    bool modify(int fd, uint32_t events);
+    // Waits for a running callback of the file descriptor, unless it is called by the event loop thread itself
+    void unwatch(int fd);
+
+   private:
+    io_event_loop();
+
+    void process_events();
+
+    int m_epoll_fd = -1;
+    // Wakes up the event loop thread, when it has to exit
+    int m_wake_fd = -1;
+    std::map<int, std::shared_ptr<event_callback>> m_callbacks;
+    std::optional<int> m_running_fd;
+    std::mutex m_callbacks_mutex;
+    std::condition_variable m_callback_finished;
+    bool m_exit_thread = false;
+    std::thread m_loop_thread;
+
+    static inline constexpr int _max_events_per_wait = 32;
+
+    friend class singleton<io_event_loop>;
+};
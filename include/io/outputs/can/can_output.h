@@ -1,9 +1,14 @@
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <type_traits>
 
 #include "io/interfaces/can/can.h"
+#include "io/interfaces/can/can_transport.h"
 #include "io/outputs/output_interface.h"
+#include "io/outputs/output_transition.h"
 #include "io/outputs/output_value.h"
 #include "value_transitioner.h"
 
@@ -22,40 +27,59 @@ class can_output final : public output_interface {
     virtual std::optional<output_value> is_overriden() const override;
     virtual output_value current_state() const override;
 
+    // Outputs on the same can interface are sent with one system call
+    virtual const void *batch_driver() const override;
+    virtual std::vector<bool> control_outputs(const output_batch &batch) override;
+
     static std::unique_ptr<can_output> create_for_interface(const nlohmann::json &description);
 
    private:
     template<typename Callable>
-    can_output(std::shared_ptr<can> can_instance, can_object_identifier identifier, const output_value &initial_value,
-               Callable transition);
+    can_output(std::shared_ptr<can> can_instance, std::shared_ptr<can_transport> transport,
+               can_object_identifier identifier, const output_value &initial_value, Callable transition);
 
-    can_error_code update_value();
-    can_error_code sync_values();
+    std::optional<can_message> message_of(const output_value &value) const;
+    // Strings are sent by the transport, the result of their transfer is only awaited with wait_for_delivery
+    can_error_code update_value(const output_value &value, bool wait_for_delivery = true);
+    // Outputs without a transition send the target right away, the others send their current value and the
+    // transition engine pushes the rest
+    can_error_code sync_values(const output_value &target_value);
+    output_value value_to_send(const output_value &target_value) const;
 
     output_value m_value;
-    value_transitioner<output_value> m_transitioner;
     std::optional<output_value> m_overriden_value{};
     can_object_identifier m_object_identifier;
     std::shared_ptr<can> m_can_instance;
+    // Strings are sent segmented, if the node answers with flow control frames
+    std::shared_ptr<can_transport> m_transport;
+    std::atomic_bool m_reported_missing_transport = false;
+    const bool m_is_instant;
+    // Declared last, so the transition is stopped before the members, which are used by the pushes, are destroyed
+    value_transitioner<output_value> m_transitioner;
+
+    static inline constexpr std::chrono::milliseconds _min_push_interval{20};
 };
 
 template<typename TransitionStep>
-can_output::can_output(std::shared_ptr<can> can_instance, can_object_identifier identifier,
-                       const output_value &initial_value, TransitionStep transition)
+can_output::can_output(std::shared_ptr<can> can_instance, std::shared_ptr<can_transport> transport,
+                       can_object_identifier identifier, const output_value &initial_value, TransitionStep transition)
     : m_object_identifier(identifier),
       m_can_instance(can_instance),
+      m_transport(std::move(transport)),
       m_value(initial_value),
+      m_is_instant(std::is_same_v<std::decay_t<TransitionStep>, output_transitions::instant<>>),
       m_transitioner(initial_value) {
-    m_transitioner.start_transition_thread(
-        [this, transition](auto time_diff, auto &input, const auto &output) -> transition_state {
-            auto result = transition(time_diff, input, output);
-
-            if (result == transition_state::value_did_change || result == transition_state::finished_transition) {
-                sync_values();
+    // Intermediate values of a transition are sent by the push thread of the transition engine, if the bus is behind
+    // only the latest value is sent. Outputs without a transition already sent the value, when it was controlled
+    m_transitioner.push_changes_to(
+        [this](const auto &value) {
+            if (m_is_instant || update_value(value, false) == can_error_code::ok) {
+                value_changed(value);
             }
-
-            return result;
         },
+        _min_push_interval);
+    m_transitioner.start_transition_thread(
+        transition,
         /* TODO: set this value based on the period value defined in the TransitionStep instance */
         std::chrono::milliseconds(100));
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -30,7 +31,7 @@ class mqtt_output final : public output_interface {
 
    private:
     bool sync_values();
-    bool update_value();
+    bool update_value(const output_value &value);
 
     template<typename Callable>
     mqtt_output(std::shared_ptr<mqtt> mqtt_instance, mqtt_topic topic, const output_value &initial_value,
@@ -40,23 +41,27 @@ class mqtt_output final : public output_interface {
     mqtt_topic m_topic;
     output_value m_value;
     std::optional<output_value> m_overriden_value;
+    // Declared last, so the transition is stopped before the members, which are used by the pushes, are destroyed
     value_transitioner<output_value> m_transitioner;
+
+    static inline constexpr std::chrono::milliseconds _min_push_interval{100};
 };
 
 template<typename Callable>
 mqtt_output::mqtt_output(std::shared_ptr<mqtt> mqtt_instance, mqtt_topic topic, const output_value &initial_value,
                          Callable transition_step)
     : m_mqtt_instance(mqtt_instance), m_topic(topic), m_value(initial_value), m_transitioner(initial_value) {
-    m_transitioner.start_transition_thread(
-        [this, transition_step](auto time_diff, auto &input, const auto &output) -> transition_state {
-            auto result = transition_step(time_diff, input, output);
-
-            if (result == transition_state::value_did_change || result == transition_state::finished_transition) {
-                sync_values();
+    // Intermediate values of a transition are sent by the push thread of the transition engine, if the bus is behind
+    // only the latest value is sent
+    m_transitioner.push_changes_to(
+        [this](const auto &value) {
+            if (update_value(value)) {
+                value_changed(value);
             }
-
-            return result;
         },
+        _min_push_interval);
+    m_transitioner.start_transition_thread(
+        transition_step,
         /* TODO: set this value based on the period value defined in the TransitionStep instance */
         std::chrono::milliseconds(100));
 }
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "io/outputs/output_value.h"
+#include "io/outputs/outputs.h"
+
+enum struct output_change_source : uint8_t { control = 0, override = 1, restore = 2, transition = 3 };
+
+struct output_change {
+    output_handle m_output;
+    output_value m_value;
+    output_change_source m_source;
+    std::chrono::steady_clock::time_point m_timestamp;
+};
+
+// Changes are queued per subscriber, if a subscriber doesn't keep up, new changes are dropped and counted instead of
+// blocking the output, which published them
+class output_change_subscription final {
+   public:
+    output_change_subscription(const output_change_subscription &other) = delete;
+    output_change_subscription(output_change_subscription &&other) = delete;
+    ~output_change_subscription();
+
+    output_change_subscription &operator=(const output_change_subscription &other) = delete;
+    output_change_subscription &operator=(output_change_subscription &&other) = delete;
+
+    std::optional<output_change> try_pop();
+    // Blocks until a change is available or the timeout has passed
+    std::optional<output_change> wait_pop(std::chrono::milliseconds timeout);
+    size_t dropped_changes() const;
+
+   private:
+    explicit output_change_subscription(size_t capacity);
+
+    void push(const output_change &change);
+
+    bounded_queue<output_change> m_changes;
+    std::atomic<size_t> m_dropped_changes{0};
+    // Publishers only take the mutex to wake up the subscriber, if it is waiting
+    std::atomic<bool> m_is_waiting{false};
+    std::mutex m_wait_mutex;
+    std::condition_variable m_changes_available;
+
+    friend class output_change_bus;
+};
+
+// Every successful control, override, restore and transition step of an output is published to all the subscribers,
+// so nobody has to poll the state of the outputs
+class output_change_bus final {
+   public:
+    output_change_bus() = delete;
+
+    // The subscription ends, when the returned subscription is destroyed
+    static std::shared_ptr<output_change_subscription> subscribe(size_t capacity = _default_capacity);
+    static void publish(output_handle output, const output_value &value, output_change_source source);
+    static bool has_subscribers();
+
+   private:
+    using subscriber_list = std::vector<std::weak_ptr<output_change_subscription>>;
+
+    static void remove_expired_subscribers();
+
+    // The list is replaced as a whole, when a subscriber is added or removed, so publishers never wait for a lock
+    static inline std::shared_ptr<const subscriber_list> _subscribers = std::make_shared<const subscriber_list>();
+    static inline std::mutex _subscribers_mutex;
+    static inline std::atomic<size_t> _number_of_subscribers{0};
+
+    static inline constexpr size_t _default_capacity = 256;
+
+    friend class output_change_subscription;
+};
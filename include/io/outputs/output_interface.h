@@ -4,6 +4,8 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "nlohmann/json.hpp"
 
@@ -14,6 +16,9 @@ using json = nlohmann::json;
 
 class output_interface {
    public:
+    using change_callback = std::function<void(const output_value &value)>;
+    using output_batch = std::vector<std::pair<output_interface *, output_value>>;
+
     output_interface() = default;
     virtual ~output_interface() = default;
 
@@ -23,7 +28,22 @@ class output_interface {
     virtual std::optional<output_value> is_overriden() const = 0;
     virtual output_value current_state() const = 0;
 
+    // Outputs which return the same driver can be controlled together with control_outputs, outputs without a driver
+    // are always controlled one by one
+    virtual const void *batch_driver() const;
+    // Controls all the outputs of the batch, which share the driver of this output and are of the same type, the
+    // default controls them one by one. Returns the result of every control
+    virtual std::vector<bool> control_outputs(const output_batch &batch);
+
+    // Called with the new value, when the output changes its value on its own (e.g. during a transition), has to be
+    // set before the output is used
+    virtual void on_value_changed(change_callback callback);
+
+   protected:
+    void value_changed(const output_value &value) const;
+
    private:
+    change_callback m_on_value_changed;
 };
 
 class output_factory : public singleton<output_factory> {
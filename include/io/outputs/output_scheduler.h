@@ -1,61 +1,205 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <shared_mutex>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "io/outputs/output_value.h"
 #include "io/outputs/outputs.h"
+#include "pattern_templates/singleton.h"
 
 class batch_output_control final {
    public:
+    using output_control_type = std::pair<output_handle, output_value>;
+
+    // Origins are indices chosen by the caller (e.g. the position of an action in a list of actions), which are
+    // reported back with the result of every output control
+    static inline constexpr size_t no_origin = std::numeric_limits<size_t>::max();
+    // Controls of unknown output ids use this handle, they are reported as failed controls of the batch
+    static inline constexpr output_handle unknown_output{std::numeric_limits<uint32_t>::max()};
+
     batch_output_control() = default;
     batch_output_control(const std::vector<std::pair<output_id, output_value>> &output_control);
 
     batch_output_control &add_output_control(std::pair<output_id, output_value> output_control);
+    batch_output_control &add_output_control(output_control_type output_control);
     batch_output_control &add_output_controls(const std::vector<std::pair<output_id, output_value>> &output_control);
+    batch_output_control &add_output_controls(const std::vector<output_control_type> &output_control,
+                                              size_t origin = no_origin);
     batch_output_control &optimize_outputs(bool value);
+    batch_output_control &timeout(std::chrono::milliseconds batch_timeout);
+    batch_output_control &output_timeout(std::chrono::milliseconds single_output_timeout);
 
     size_t number_of_occured_errors() const;
     bool optimize_outputs() const;
+    std::chrono::milliseconds timeout() const;
+    std::chrono::milliseconds output_timeout() const;
     std::vector<output_id> occured_errors() const;
-    std::vector<std::pair<output_id, output_value>> output_controls() const;
+    const std::vector<output_control_type> &output_controls() const;
+    const std::vector<size_t> &origins() const;
 
    private:
-    std::vector<std::pair<output_id, output_value>> m_output_controls;
+    std::vector<output_control_type> m_output_controls;
+    std::vector<size_t> m_origins;
     std::vector<output_id> m_failures;
     bool m_optimize_outputs = false;
+    // Controls which aren't done when the timeout of the batch or their output has passed are reported as timed out
+    std::chrono::milliseconds m_timeout = _default_timeout;
+    std::chrono::milliseconds m_output_timeout = _default_output_timeout;
+
+    static inline constexpr std::chrono::milliseconds _default_timeout{30000};
+    static inline constexpr std::chrono::milliseconds _default_output_timeout{10000};
 };
 
-enum struct output_control_result : uint8_t { success = 0, failure = 1, skipped = 2 };
+// Timed out controls aren't cancelled, the task keeps its worker and its outputs until the output returns. So a timed
+// out control may still be applied after the result of its batch was reported
+enum struct output_control_result : uint8_t { success = 0, failure = 1, skipped = 2, timed_out = 3 };
+
+struct output_control_report {
+    batch_output_control::output_control_type control;
+    output_control_result result;
+    size_t origin;
+};
 
 struct batch_output_control_result {
-    using output_control_type = std::pair<output_id, output_value>;
+    using output_control_type = batch_output_control::output_control_type;
+
+    std::vector<size_t> failed_origins(size_t number_of_origins) const;
 
     const bool batch_result = false;
     const std::vector<output_control_type> output_controls;
-    const std::vector<std::pair<output_control_type, output_control_result>> control_results;
+    const std::vector<output_control_report> control_results;
+};
+
+// Statistics of the queue of one interface type, the dispatch latency is the time between queueing a part of a batch
+// and the start of its execution
+struct output_queue_statistics {
+    std::string type;
+    size_t number_of_workers;
+    size_t queue_depth;
+    size_t executed_tasks;
+    size_t cancelled_tasks;
+    std::chrono::microseconds last_dispatch_latency;
+    std::chrono::microseconds max_dispatch_latency;
 };
 
+// Batches are split into one task per output or per driver, if the outputs can be controlled together (e.g. the pins
+// of one gpio chip). The tasks are queued by the interface type of the outputs (gpio, can, mqtt, ...). Every interface
+// type has its own long-lived workers, so slow interfaces don't delay the fast ones. The number of workers per
+// interface type is configured with the "output_workers" entry of the config. The controls of one output are never
+// executed concurrently and keep their order
 class output_scheduler final {
    public:
-    // static std::shared_ptr<output_scheduler> instance();
+    static std::shared_ptr<output_scheduler> instance();
+
+    using result_callback = std::function<void(batch_output_control_result)>;
 
-    // Since this is asynchronous use shared_ptr so the batch_output_control is not invalidated before the operation is
-    // done
     static std::future<batch_output_control_result> execute_batch_output_control(const batch_output_control &job);
+    // The callback is called by the thread which completes the batch (a worker or the watchdog), it is called
+    // directly, if the batch doesn't contain any controls, which can be executed
+    static void execute_batch_output_control(const batch_output_control &job, result_callback on_finished);
+    static std::vector<output_queue_statistics> queue_statistics();
+
+    ~output_scheduler();
 
    private:
-    output_scheduler() = delete;
+    struct batch_state {
+        batch_output_control m_job;
+        std::vector<output_control_report> m_reports;
+        std::vector<size_t> m_executed_controls;
+        // The controls of every task and if the task already contributed to the result (finished or timed out)
+        std::vector<std::vector<size_t>> m_task_controls;
+        std::vector<bool> m_task_done;
+        size_t m_remaining_tasks = 0;
+        bool m_is_finished = false;
+        std::chrono::steady_clock::time_point m_deadline;
+        std::mutex m_state_mutex;
+        result_callback m_on_finished;
+    };
+
+    // Part of a batch, which contains the controls of one output or of all the outputs of one driver
+    struct output_task {
+        std::shared_ptr<batch_state> m_batch;
+        size_t m_task_index;
+        std::vector<output_handle> m_outputs;
+        std::chrono::steady_clock::time_point m_queued_at;
+    };
+
+    // Deadline of a single task or of the whole batch, if there is no task index
+    struct watched_deadline {
+        std::weak_ptr<batch_state> m_batch;
+        std::optional<size_t> m_task_index;
+    };
+
+    class worker_queue final {
+       public:
+        worker_queue(output_scheduler &scheduler, std::string type, size_t number_of_workers);
+        ~worker_queue();
+
+        void push(output_task task);
+        output_queue_statistics statistics() const;
+
+       private:
+        void process_tasks();
+        std::deque<output_task>::iterator find_runnable_task();
+
+        output_scheduler &m_scheduler;
+        const std::string m_type;
+        std::deque<output_task> m_tasks;
+        std::set<output_handle> m_busy_outputs;
+        mutable std::mutex m_tasks_mutex;
+        std::condition_variable m_tasks_changed;
+        bool m_should_exit = false;
+        size_t m_executed_tasks = 0;
+        size_t m_cancelled_tasks = 0;
+        std::chrono::microseconds m_last_dispatch_latency{0};
+        std::chrono::microseconds m_max_dispatch_latency{0};
+        std::vector<std::thread> m_worker_threads;
+    };
+
+    output_scheduler();
+
+    worker_queue &queue_of(const std::string &type);
+    void watch(std::chrono::steady_clock::time_point deadline, watched_deadline watched);
+    void unwatch(std::chrono::steady_clock::time_point deadline, const std::shared_ptr<batch_state> &batch,
+                 std::optional<size_t> task_index);
+    void watchdog();
+    void execute_task(output_task &task);
+    static std::vector<size_t> coalesce_controls(batch_state &batch);
+    static size_t configured_workers(const std::string &type);
+    static bool complete_task(batch_state &batch, size_t task_index, std::vector<output_control_report> reports);
+    static void time_out(batch_state &batch, std::optional<size_t> task_index);
+    static void dispatch_batch(std::shared_ptr<batch_state> batch);
+    static batch_output_control_result collect_result(batch_state &batch);
+    static void finish_batch(batch_state &batch, batch_output_control_result result);
+
+    // The destructor stops the queues before the watchdog, so the watchdog outlives the workers, which still register
+    // deadlines
+    std::multimap<std::chrono::steady_clock::time_point, watched_deadline> m_deadlines;
+    std::mutex m_deadlines_mutex;
+    std::condition_variable m_deadlines_changed;
+    bool m_stop_watchdog = false;
+    std::thread m_watchdog_thread;
 
-    static batch_output_control_result do_output_job(batch_output_control job);
+    std::map<std::string, std::unique_ptr<worker_queue>> m_queues;
+    std::mutex m_queues_mutex;
 
-    // static inline std::shared_ptr<output_scheduler> _instance = nullptr;
-    // static inline std::mutex _instance_mutex{};
+    static inline constexpr size_t _default_workers_per_type = 1;
+    static inline constexpr size_t _max_workers_per_type = 16;
 
-    // std::vector<std::shared_ptr<batch_output_control>> m_outputs_to_set;
+    friend class singleton<output_scheduler>;
 };
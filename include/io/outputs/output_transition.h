@@ -1,6 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
 
 #include "logger.h"
 #include "output_value.h"
@@ -92,4 +97,137 @@ namespace output_transitions {
 
         return transition_state::value_did_not_change;
     }
+
+    enum struct transition_curve { linear, ease_in_out, sunrise };
+
+    std::optional<transition_curve> curve_from_string(const std::string &curve_name);
+
+    // Maps the elapsed part of the duration of a transition (0 to 1) to the part of the distance between the start
+    // and the target value (0 to 1)
+    double curve_progress(transition_curve curve, double time_progress);
+
+    // Pure function of the start value, the target value and the progress of the transition, values of a type which
+    // can't be interpolated jump to the target value
+    output_value interpolate(const output_value &start_value, const output_value &target_value, double progress);
+
+    // The value of this transition only depends on the start value, the target value, the start time, the duration
+    // and the curve, so it doesn't drift with the scheduling of the steps. Every step evaluates the curve at the
+    // current time, a new target value starts a new transition from the current value
+    template<typename PeriodType = std::chrono::milliseconds>
+    class timed_transition {
+       public:
+        using clock_type = std::chrono::steady_clock;
+
+        timed_transition(transition_curve curve, PeriodType duration);
+
+        transition_state operator()(std::chrono::milliseconds delta, output_value &current_value,
+                                    const output_value &target_value) const;
+        output_value value_at(clock_type::time_point point_in_time) const;
+
+       private:
+        transition_curve m_curve = transition_curve::linear;
+        PeriodType m_duration{0};
+
+        mutable std::optional<output_value> m_start_value;
+        mutable std::optional<output_value> m_target_value;
+        mutable clock_type::time_point m_start_time;
+    };
+
+    template<typename PeriodType>
+    timed_transition<PeriodType>::timed_transition(transition_curve curve, PeriodType duration)
+        : m_curve(curve), m_duration(duration) {}
+
+    template<typename PeriodType>
+    transition_state timed_transition<PeriodType>::operator()(std::chrono::milliseconds delta,
+                                                              output_value &current_value,
+                                                              const output_value &target_value) const {
+        auto now = clock_type::now();
+
+        if (!m_target_value.has_value() || !(*m_target_value == target_value)) {
+            m_start_value = current_value;
+            m_target_value = target_value;
+            m_start_time = now;
+        }
+
+        if (current_value == target_value) {
+            return transition_state::finished_transition;
+        }
+
+        auto new_value = value_at(now);
+
+        if (new_value == current_value) {
+            return transition_state::value_did_not_change;
+        }
+
+        current_value = std::move(new_value);
+
+        return current_value == target_value ? transition_state::finished_transition
+                                             : transition_state::value_did_change;
+    }
+
+    template<typename PeriodType>
+    output_value timed_transition<PeriodType>::value_at(clock_type::time_point point_in_time) const {
+        if (!m_start_value.has_value() || !m_target_value.has_value()) {
+            return m_target_value.value_or(output_value(0));
+        }
+
+        if (m_duration <= PeriodType(0) || point_in_time >= m_start_time + m_duration) {
+            return *m_target_value;
+        }
+
+        double time_progress = std::chrono::duration<double>(point_in_time - m_start_time) /
+                               std::chrono::duration<double>(m_duration);
+
+        return interpolate(*m_start_value, *m_target_value, curve_progress(m_curve, time_progress));
+    }
+
+    inline std::optional<transition_curve> curve_from_string(const std::string &curve_name) {
+        if (curve_name == "linear") {
+            return transition_curve::linear;
+        } else if (curve_name == "ease_in_out") {
+            return transition_curve::ease_in_out;
+        } else if (curve_name == "sunrise") {
+            return transition_curve::sunrise;
+        }
+
+        return {};
+    }
+
+    inline double curve_progress(transition_curve curve, double time_progress) {
+        // Steepness of the sunrise curve, the perceived brightness grows roughly logarithmic with the light output
+        constexpr double sunrise_steepness = 5.0;
+        double t = std::clamp(time_progress, 0.0, 1.0);
+
+        switch (curve) {
+            case transition_curve::ease_in_out:
+                return t * t * (3.0 - 2.0 * t);
+            case transition_curve::sunrise:
+                return std::expm1(sunrise_steepness * t) / std::expm1(sunrise_steepness);
+            case transition_curve::linear:
+            default:
+                return t;
+        }
+    }
+
+    inline output_value interpolate(const output_value &start_value, const output_value &target_value,
+                                    double progress) {
+        if (start_value.current_type() != target_value.current_type()) {
+            return target_value;
+        }
+
+        auto interpolate_number = [progress](auto start, auto target) {
+            double value = static_cast<double>(start) + (static_cast<double>(target) - start) * progress;
+            return static_cast<decltype(start)>(std::lround(value));
+        };
+
+        switch (target_value.current_type()) {
+            case output_value_types::number:
+                return output_value(interpolate_number(*start_value.get<int>(), *target_value.get<int>()));
+            case output_value_types::number_unsigned:
+                return output_value(
+                    interpolate_number(*start_value.get<unsigned int>(), *target_value.get<unsigned int>()));
+            default:
+                return target_value;
+        }
+    }
 }  // namespace output_transitions
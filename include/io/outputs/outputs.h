@@ -1,10 +1,17 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "io/outputs/output_interface.h"
 #include "nlohmann/json.hpp"
@@ -13,24 +20,64 @@ using json = nlohmann::json;
 
 using output_id = std::string;
 
+// Dense index of an output, which is resolved once from the output_id, so the hot paths don't have to compare strings
+enum struct output_handle : uint32_t {};
+
+enum struct output_change_source : uint8_t;
+
 class outputs {
    public:
     static bool is_valid_id(const output_id &id);
+    static std::optional<output_handle> find_handle(const output_id &id);
+    static std::optional<output_id> id_of(const output_handle &handle);
+    static std::optional<std::string> type_of(const output_handle &handle);
+    static size_t number_of_outputs();
     static bool control_output(const output_id &id, const output_value &action);
+    static bool control_output(const output_handle &handle, const output_value &action);
+    // Outputs which share a driver are controlled with one call of the driver, returns the result of every control
+    static std::vector<bool> control_outputs(const std::vector<std::pair<output_handle, output_value>> &controls);
+    // Outputs with the same driver can be controlled together, nullptr if the output is always controlled on its own
+    static std::optional<const void *> batch_driver_of(const output_handle &handle);
     static std::optional<output_value> is_overriden(const output_id &id);
     static bool override_with(const output_id &id, const output_value &action);
     static bool restore_control(const output_id &id);
     static std::optional<output_value> current_state(const output_id &id);
+    static std::optional<output_value> current_state(const output_handle &handle);
     static std::vector<output_id> get_ids();
 
    private:
-    using outputs_map_type = std::map<output_id, std::unique_ptr<output_interface>>;
+    // Every output has its own lock, so operations on different outputs don't wait for each other
+    struct output_entry {
+        output_id m_id;
+        std::string m_type;
+        std::unique_ptr<output_interface> m_output;
+        std::unique_ptr<std::mutex> m_output_mutex;
+        output_handle m_handle;
+    };
+
+    using outputs_list_type = std::vector<output_entry>;
+    using handle_map_type = std::map<output_id, output_handle>;
 
     static bool add_output(json &gpio_description);
-    static outputs_map_type::iterator find_output(const output_id &id);
+    // Have to be called with _list_mutex locked
+    static output_entry *find_entry(const output_id &id);
+    static output_entry *find_entry(const output_handle &handle);
+    // Calls func with the output locked, returns nothing if the output doesn't exist
+    template<typename Func>
+    static std::optional<std::invoke_result_t<Func, output_interface &>> with_output(const output_id &id, Func func);
+    template<typename Func>
+    static std::optional<std::invoke_result_t<Func, output_interface &>> with_output(const output_handle &handle,
+                                                                                     Func func);
+    // Like with_output, but publishes the new state of the output to the output_change_bus, if func succeeded
+    template<typename Key, typename Func>
+    static bool change_output(const Key &key, output_change_source source, Func func);
+
+    // The list is only modified while the outputs are loaded, afterwards all the operations only need a shared lock
+    static inline outputs_list_type _outputs;
+    static inline handle_map_type _output_handles;
+    static inline std::shared_mutex _list_mutex;
 
-    static inline outputs_map_type _outputs;
-    static inline std::recursive_mutex _list_mutex;
+    static inline constexpr std::chrono::milliseconds _default_resync_interval{std::chrono::minutes(10)};
 
     friend class schedule;
 };
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "io/outputs/output_transition.h"
+
+namespace output_transitions {
+    // Evaluates many numeric timed transitions at once. The transitions are stored as a structure of arrays, so every
+    // pass over them works on contiguous plain numbers without any variant or output_value copies
+    class transition_batch final {
+       public:
+        using clock_type = std::chrono::steady_clock;
+        using index_type = uint32_t;
+
+        index_type add(double start_value, double target_value, clock_type::time_point start_time,
+                       std::chrono::milliseconds duration, transition_curve curve);
+        // The last transition takes the place of the removed one
+        void remove(index_type index);
+        void clear();
+
+        // Computes the current values of all transitions
+        void evaluate(clock_type::time_point now);
+
+        const std::vector<double> &values() const;
+        bool is_finished(index_type index) const;
+        size_t size() const;
+
+       private:
+        std::vector<double> m_start_values;
+        std::vector<double> m_target_values;
+        std::vector<double> m_start_times;
+        std::vector<double> m_durations;
+        std::vector<transition_curve> m_curves;
+
+        // Results of the last evaluation
+        std::vector<double> m_progress;
+        std::vector<double> m_values;
+
+        clock_type::time_point m_epoch = clock_type::now();
+    };
+
+    inline auto transition_batch::add(double start_value, double target_value, clock_type::time_point start_time,
+                                      std::chrono::milliseconds duration, transition_curve curve) -> index_type {
+        m_start_values.push_back(start_value);
+        m_target_values.push_back(target_value);
+        m_start_times.push_back(std::chrono::duration<double, std::milli>(start_time - m_epoch).count());
+        m_durations.push_back(static_cast<double>(duration.count()));
+        m_curves.push_back(curve);
+        m_progress.push_back(0.0);
+        m_values.push_back(start_value);
+
+        return static_cast<index_type>(m_start_values.size() - 1);
+    }
+
+    inline void transition_batch::remove(index_type index) {
+        auto remove_from = [index](auto &values) {
+            values[index] = values.back();
+            values.pop_back();
+        };
+
+        remove_from(m_start_values);
+        remove_from(m_target_values);
+        remove_from(m_start_times);
+        remove_from(m_durations);
+        remove_from(m_curves);
+        remove_from(m_progress);
+        remove_from(m_values);
+    }
+
+    inline void transition_batch::clear() {
+        m_start_values.clear();
+        m_target_values.clear();
+        m_start_times.clear();
+        m_durations.clear();
+        m_curves.clear();
+        m_progress.clear();
+        m_values.clear();
+    }
+
+    inline void transition_batch::evaluate(clock_type::time_point now) {
+        const size_t number_of_transitions = m_start_values.size();
+        const double now_ms = std::chrono::duration<double, std::milli>(now - m_epoch).count();
+
+        // Progress in time, this loop doesn't branch, so the compiler can vectorize it
+        for (size_t i = 0; i < number_of_transitions; ++i) {
+            double elapsed = now_ms - m_start_times[i];
+            double time_progress = m_durations[i] > 0.0 ? elapsed / m_durations[i] : 1.0;
+            m_progress[i] = std::clamp(time_progress, 0.0, 1.0);
+        }
+
+        // Only the sunrise curve needs a transcendental function, the others are simple polynomials
+        for (size_t i = 0; i < number_of_transitions; ++i) {
+            if (m_curves[i] != transition_curve::linear) {
+                m_progress[i] = curve_progress(m_curves[i], m_progress[i]);
+            }
+        }
+
+        for (size_t i = 0; i < number_of_transitions; ++i) {
+            m_values[i] = m_start_values[i] + (m_target_values[i] - m_start_values[i]) * m_progress[i];
+        }
+    }
+
+    inline const std::vector<double> &transition_batch::values() const { return m_values; }
+
+    inline bool transition_batch::is_finished(index_type index) const { return m_progress[index] >= 1.0; }
+
+    inline size_t transition_batch::size() const { return m_start_values.size(); }
+}  // namespace output_transitions
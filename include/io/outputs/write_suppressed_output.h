@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include "io/outputs/output_interface.h"
+#include "io/outputs/output_value.h"
+
+// Wraps an output and skips writes, which wouldn't change what was last confirmed by the output. Once the resync
+// interval has passed since the last write, the next write is passed through anyway, so an output which was changed
+// by somebody else is corrected eventually
+class write_suppressed_output final : public output_interface {
+   public:
+    write_suppressed_output(std::unique_ptr<output_interface> output, std::chrono::milliseconds resync_interval);
+    virtual ~write_suppressed_output() = default;
+
+    virtual bool control_output(const output_value &value) override;
+    virtual bool override_with(const output_value &value) override;
+    virtual bool restore_control() override;
+    virtual std::optional<output_value> is_overriden() const override;
+    virtual output_value current_state() const override;
+    virtual void on_value_changed(change_callback callback) override;
+    virtual const void *batch_driver() const override;
+    // Only called with batches of suppressed outputs, the writes which aren't suppressed are passed to the driver of
+    // the wrapped outputs as one batch
+    virtual std::vector<bool> control_outputs(const output_batch &batch) override;
+
+    size_t suppressed_writes() const;
+
+   private:
+    bool is_resync_due() const;
+    // Remembers the time of a successful write, after a failed write nothing is known about the state of the output
+    bool confirm_write(bool write_result);
+
+    std::unique_ptr<output_interface> m_output;
+    std::optional<output_value> m_confirmed_control;
+    std::optional<output_value> m_confirmed_override;
+    std::optional<std::chrono::steady_clock::time_point> m_last_write;
+    const std::chrono::milliseconds m_resync_interval;
+    size_t m_suppressed_writes = 0;
+};
@@ -11,6 +11,7 @@
 #include "chrono_time.h"
 #include "network/rest_resource.h"
 #include "schedule/schedule_event.h"
+#include "schedule/schedule_timeline.h"
 
 using json = nlohmann::json;
 
@@ -27,12 +28,15 @@ class schedule final : public rest_resource<schedule> {
     schedule &title(const std::string &new_title);
     schedule &schedule_mode(const mode &new_mode);
     bool add_event(const schedule_event &event);
+    schedule &compile_timeline();
 
     std::optional<days> start_at() const;
     std::optional<days> end_at() const;
     days period() const;
     const std::string &title() const;
     const std::vector<schedule_event> &events() const;
+    schedule_timeline &timeline();
+    const schedule_timeline &timeline() const;
     mode schedule_mode() const;
 
     explicit operator bool() const;
@@ -49,6 +53,7 @@ class schedule final : public rest_resource<schedule> {
     std::string m_title{""};
     mode m_mode{mode::repeating};
     std::vector<schedule_event> m_events;
+    schedule_timeline m_timeline;
 
     static inline std::atomic_int _instance_count = 0;
 };
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -14,10 +19,20 @@ using json = nlohmann::json;
 
 using schedule_action_id = std::string;
 
+// Dense index of an action, which is resolved once when the schedule is loaded
+enum struct schedule_action_handle : uint32_t {};
+
 class schedule_action {
    public:
     static bool is_valid_id(const schedule_action_id &id);
+    static std::optional<schedule_action_handle> find_handle(const schedule_action_id &id);
     static std::vector<schedule_action_id> execute_actions(const std::vector<schedule_action_id> &ids);
+    using actions_callback = std::function<void(std::vector<size_t> failed_positions)>;
+
+    // Returns the positions of the failed actions in the provided list of handles
+    static std::vector<size_t> execute_actions(const std::vector<schedule_action_handle> &handles);
+    // Doesn't wait for the outputs, the positions of the failed actions are provided to the callback
+    static void execute_actions(const std::vector<schedule_action_handle> &handles, actions_callback on_finished);
 
     schedule_action() = default;
     schedule_action(const schedule_action &other) = delete;
@@ -34,9 +49,13 @@ class schedule_action {
 
     schedule_action_id m_id;
     std::vector<std::pair<output_id, output_value>> m_outputs;
+    std::vector<std::pair<output_handle, output_value>> m_output_controls;
 
     static inline std::vector<std::unique_ptr<schedule_action>> _actions;
+    static inline std::map<schedule_action_id, schedule_action_handle> _action_handles;
     static inline std::recursive_mutex _instance_mutex;
 
+    static inline constexpr std::chrono::seconds _result_grace_period{5};
+
     friend class schedule;
 };
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -22,16 +27,47 @@ class schedule_handler {
     // static http::response<http::dynamic_body> handle_request(const http::request<http::dynamic_body> &request);
 
    private:
+    // Point in time (local time in seconds since epoch) at which the next event of an active schedule is due
+    struct schedule_deadline {
+        std::chrono::seconds m_trigger_at;
+        size_t m_schedule_index;
+    };
+
+    struct is_later_deadline {
+        bool operator()(const schedule_deadline &lhs, const schedule_deadline &rhs) const;
+    };
+
     schedule_handler() = default;
     static void event_handler();
+    static std::optional<std::chrono::seconds> next_trigger_time(const schedule &sched);
     bool is_conflicting_with_other_schedules(const schedule &sched);
+    void process_due_events(schedule &sched, const days &current_day, const std::chrono::seconds &now);
+    void handle_failed_actions(const std::string &schedule_title,
+                               const std::vector<schedule_timeline::entry_index> &action_entries,
+                               const std::vector<size_t> &failed_actions);
+    void update_active_schedules(const days &current_day);
+    void rebuild_deadlines();
+    void push_deadline(size_t schedule_index, std::chrono::seconds trigger_at);
+    void wake_up_event_handler();
 
     std::vector<schedule> m_active_schedules;
     std::vector<schedule> m_inactive_schedules;
+    std::priority_queue<schedule_deadline, std::vector<schedule_deadline>, is_later_deadline> m_deadlines;
+    // The valid deadline of every active schedule, entries of the heap which don't match are outdated and skipped
+    std::vector<std::optional<std::chrono::seconds>> m_current_deadlines;
     std::recursive_mutex m_schedules_list_mutex;
     std::thread m_event_thread;
+    std::mutex m_wake_up_mutex;
+    std::condition_variable m_wake_up;
     bool m_is_started = false;
     std::atomic_bool m_should_exit = false;
+    std::atomic_bool m_schedules_changed = false;
+    std::atomic_bool m_deadlines_changed = false;
+
+    // Failed events are tried again after this interval
+    static inline constexpr std::chrono::seconds _retry_interval{5};
+    // Upper bound for sleeping, so adjustments of the wall clock are noticed in time
+    static inline constexpr std::chrono::seconds _max_sleep_time{60};
 
     friend class singleton<schedule_handler>;
 };
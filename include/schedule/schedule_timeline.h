@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "chrono_time.h"
+#include "schedule/schedule_action.h"
+
+class schedule_event;
+
+// Flat representation of the events of a schedule sorted by their trigger time, the actions are resolved to their
+// handles. The cursor points to the first entry which wasn't processed yet, so finding the due events doesn't require a
+// scan over all events
+class schedule_timeline final {
+   public:
+    using entry_index = uint32_t;
+    using action_iterator = std::vector<schedule_action_handle>::const_iterator;
+
+    struct entry {
+        days m_day;
+        std::chrono::minutes m_trigger_time;
+        entry_index m_event_index;
+        uint32_t m_actions_begin;
+        uint32_t m_actions_end;
+    };
+
+    static schedule_timeline compile(const std::vector<schedule_event> &events);
+
+    std::vector<entry_index> take_due_entries(const days &day_in_schedule, const std::chrono::minutes &time_of_day);
+    // The entry is returned again by the first call of take_due_entries, the retry time is the point in time (local
+    // time in seconds since epoch) at which the retry is due at the latest
+    void retry(entry_index index, std::chrono::seconds retry_at);
+    void reset();
+
+    // The trigger time of the next entry, which wasn't processed yet, retries aren't included
+    std::optional<std::pair<days, std::chrono::minutes>> next_trigger_time() const;
+    std::optional<std::chrono::seconds> next_retry_time() const;
+    const entry &at(entry_index index) const;
+    std::pair<action_iterator, action_iterator> actions_of(const entry &timeline_entry) const;
+    size_t size() const;
+
+   private:
+    struct pending_retry {
+        entry_index m_index;
+        std::chrono::seconds m_retry_at;
+    };
+
+    std::vector<entry> m_entries;
+    std::vector<schedule_action_handle> m_actions;
+    // Sorted by the index of the entry
+    std::vector<pending_retry> m_retries;
+    entry_index m_cursor = 0;
+};
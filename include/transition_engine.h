@@ -0,0 +1,280 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "pattern_templates/singleton.h"
+
+// Drives all the transitions, which are in progress, with one thread. A transition is only registered while it is in
+// progress, a step returns the point in time of the next step or nothing, if the transition is finished.
+// Changed values are pushed to the outputs by a second thread, so slow buses don't delay the steps. Pushes are rate
+// limited per transition and coalesced, the push function is expected to send the latest value
+class transition_engine final {
+   public:
+    using clock_type = std::chrono::steady_clock;
+    using transition_id = uint64_t;
+    using step_function = std::function<std::optional<clock_type::time_point>()>;
+    using push_function = std::function<void()>;
+
+    static std::shared_ptr<transition_engine> instance();
+
+    transition_engine(const transition_engine &other) = delete;
+    transition_engine(transition_engine &&other) = delete;
+    ~transition_engine();
+
+    transition_engine &operator=(const transition_engine &other) = delete;
+    transition_engine &operator=(transition_engine &&other) = delete;
+
+    transition_id create_id();
+    void activate(transition_id id, step_function step, clock_type::time_point next_step);
+    void request_push(transition_id id, push_function push, std::chrono::milliseconds min_interval);
+    // Waits for a running step or push of the transition, so the transition can be destroyed afterwards
+    void deactivate(transition_id id);
+    size_t number_of_active_transitions() const;
+
+   private:
+    struct active_transition {
+        step_function m_step;
+        std::optional<clock_type::time_point> m_next_step;
+        std::optional<clock_type::time_point> m_pending_step;
+        bool m_is_running = false;
+    };
+
+    struct requested_push {
+        push_function m_push;
+        std::chrono::milliseconds m_min_interval{0};
+        std::optional<clock_type::time_point> m_last_push;
+        bool m_is_pending = false;
+        bool m_is_running = false;
+    };
+
+    transition_engine();
+
+    void schedule_step(transition_id id, active_transition &transition, clock_type::time_point next_step);
+    void do_transitions();
+    void do_pushes();
+
+    std::map<transition_id, active_transition> m_transitions;
+    // Steps which don't match the next step of their transition are outdated and skipped
+    std::multimap<clock_type::time_point, transition_id> m_steps;
+    mutable std::mutex m_transitions_mutex;
+    std::condition_variable m_transitions_changed;
+    std::atomic<transition_id> m_next_id{0};
+    bool m_exit_thread = false;
+    std::thread m_transition_thread;
+
+    std::map<transition_id, requested_push> m_pushes;
+    std::mutex m_pushes_mutex;
+    std::condition_variable m_pushes_changed;
+    bool m_exit_push_thread = false;
+    std::thread m_push_thread;
+
+    friend class singleton<transition_engine>;
+};
+
+inline std::shared_ptr<transition_engine> transition_engine::instance() {
+    return singleton<transition_engine>::instance();
+}
+
+inline transition_engine::transition_engine()
+    : m_transition_thread(&transition_engine::do_transitions, this),
+      m_push_thread(&transition_engine::do_pushes, this) {}
+
+inline transition_engine::~transition_engine() {
+    {
+        std::lock_guard<std::mutex> transitions_guard{m_transitions_mutex};
+        m_exit_thread = true;
+    }
+
+    m_transitions_changed.notify_all();
+    m_transition_thread.join();
+
+    {
+        std::lock_guard<std::mutex> pushes_guard{m_pushes_mutex};
+        m_exit_push_thread = true;
+    }
+
+    m_pushes_changed.notify_all();
+    m_push_thread.join();
+}
+
+inline auto transition_engine::create_id() -> transition_id { return m_next_id.fetch_add(1); }
+
+inline void transition_engine::activate(transition_id id, step_function step, clock_type::time_point next_step) {
+    {
+        std::lock_guard<std::mutex> transitions_guard{m_transitions_mutex};
+        auto &transition = m_transitions[id];
+        transition.m_step = std::move(step);
+
+        // The step is scheduled by the engine thread, when the running step returns
+        if (transition.m_is_running) {
+            transition.m_pending_step = std::min(transition.m_pending_step.value_or(next_step), next_step);
+            return;
+        }
+
+        if (transition.m_next_step.has_value() && *transition.m_next_step <= next_step) {
+            return;
+        }
+
+        schedule_step(id, transition, next_step);
+    }
+
+    m_transitions_changed.notify_all();
+}
+
+inline void transition_engine::request_push(transition_id id, push_function push,
+                                            std::chrono::milliseconds min_interval) {
+    {
+        std::lock_guard<std::mutex> pushes_guard{m_pushes_mutex};
+        auto &current_push = m_pushes[id];
+        current_push.m_push = std::move(push);
+        current_push.m_min_interval = min_interval;
+        current_push.m_is_pending = true;
+    }
+
+    m_pushes_changed.notify_all();
+}
+
+inline void transition_engine::deactivate(transition_id id) {
+    {
+        std::unique_lock<std::mutex> transitions_guard{m_transitions_mutex};
+
+        m_transitions_changed.wait(transitions_guard, [this, id]() {
+            auto transition = m_transitions.find(id);
+            return transition == m_transitions.cend() || !transition->second.m_is_running;
+        });
+
+        m_transitions.erase(id);
+    }
+
+    std::unique_lock<std::mutex> pushes_guard{m_pushes_mutex};
+
+    m_pushes_changed.wait(pushes_guard, [this, id]() {
+        auto current_push = m_pushes.find(id);
+        return current_push == m_pushes.cend() || !current_push->second.m_is_running;
+    });
+
+    m_pushes.erase(id);
+}
+
+inline size_t transition_engine::number_of_active_transitions() const {
+    std::lock_guard<std::mutex> transitions_guard{m_transitions_mutex};
+    return m_transitions.size();
+}
+
+inline void transition_engine::schedule_step(transition_id id, active_transition &transition,
+                                             clock_type::time_point next_step) {
+    transition.m_next_step = next_step;
+    m_steps.emplace(next_step, id);
+}
+
+inline void transition_engine::do_transitions() {
+    std::unique_lock<std::mutex> transitions_guard{m_transitions_mutex};
+
+    while (!m_exit_thread) {
+        if (m_steps.empty()) {
+            m_transitions_changed.wait(transitions_guard);
+            continue;
+        }
+
+        auto [next_step_at, id] = *m_steps.begin();
+
+        if (next_step_at > clock_type::now()) {
+            m_transitions_changed.wait_until(transitions_guard, next_step_at);
+            continue;
+        }
+
+        m_steps.erase(m_steps.begin());
+        auto transition = m_transitions.find(id);
+
+        if (transition == m_transitions.cend() || transition->second.m_next_step != next_step_at) {
+            continue;
+        }
+
+        transition->second.m_next_step.reset();
+        transition->second.m_is_running = true;
+        auto step = transition->second.m_step;
+
+        transitions_guard.unlock();
+        auto next_step = step();
+        transitions_guard.lock();
+
+        // The transition can't be removed while its step is running, so the iterator is still valid
+        auto &current_transition = transition->second;
+        current_transition.m_is_running = false;
+
+        if (current_transition.m_pending_step.has_value()) {
+            next_step = std::min(next_step.value_or(*current_transition.m_pending_step),
+                                 *current_transition.m_pending_step);
+            current_transition.m_pending_step.reset();
+        }
+
+        if (next_step.has_value()) {
+            schedule_step(id, current_transition, *next_step);
+        } else {
+            m_transitions.erase(transition);
+        }
+
+        m_transitions_changed.notify_all();
+    }
+}
+
+// Pushes are only remembered as long as they limit the rate of the next push
+inline void transition_engine::do_pushes() {
+    std::unique_lock<std::mutex> pushes_guard{m_pushes_mutex};
+
+    while (!m_exit_push_thread) {
+        auto now = clock_type::now();
+        auto next_push = m_pushes.end();
+        std::optional<clock_type::time_point> next_push_at;
+
+        for (auto current_push = m_pushes.begin(); current_push != m_pushes.end();) {
+            const auto &[id, push] = *current_push;
+            auto push_at = push.m_last_push.has_value() ? *push.m_last_push + push.m_min_interval : now;
+
+            if (!push.m_is_pending && !push.m_is_running && push_at <= now) {
+                current_push = m_pushes.erase(current_push);
+                continue;
+            }
+
+            if (push.m_is_pending && !push.m_is_running && (!next_push_at.has_value() || push_at < *next_push_at)) {
+                next_push = current_push;
+                next_push_at = push_at;
+            }
+
+            ++current_push;
+        }
+
+        if (!next_push_at.has_value()) {
+            m_pushes_changed.wait(pushes_guard);
+            continue;
+        }
+
+        if (*next_push_at > now) {
+            m_pushes_changed.wait_until(pushes_guard, *next_push_at);
+            continue;
+        }
+
+        auto &current_push = next_push->second;
+        current_push.m_is_pending = false;
+        current_push.m_is_running = true;
+        current_push.m_last_push = now;
+        auto push = current_push.m_push;
+
+        pushes_guard.unlock();
+        push();
+        pushes_guard.lock();
+
+        // Entries are only erased, while they aren't running, so the reference is still valid
+        current_push.m_is_running = false;
+        m_pushes_changed.notify_all();
+    }
+}
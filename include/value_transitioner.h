@@ -1,14 +1,32 @@
 #pragma once
 
-#include <atomic>
 #include <chrono>
-#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
-#include <thread>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "transition_engine.h"
 
 enum struct transition_state { value_did_change, value_did_not_change, finished_transition };
 
-// TODO: make at least moveable
+// Transitions, which can be evaluated at any point in time (e.g. output_transitions::timed_transition)
+template<typename TransitionType, typename ValueType, typename = void>
+struct is_evaluable_transition : std::false_type {};
+
+template<typename TransitionType, typename ValueType>
+struct is_evaluable_transition<
+    TransitionType, ValueType,
+    std::enable_if_t<std::is_convertible_v<decltype(std::declval<const TransitionType &>().value_at(
+                                               std::declval<transition_engine::clock_type::time_point>())),
+                                           ValueType>>> : std::true_type {};
+
+// The steps of the transition are executed by the shared transition_engine, the transitioner is only registered there
+// while the current value differs from the target value. The current value is published as an immutable snapshot
+// after every step, so readers never wait for a running step. Transitions, which can be evaluated at any point in time,
+// also publish a copy of themselves, so the readers get the exact value at the time of the read
 template<typename ValueType>
 class value_transitioner final {
    public:
@@ -16,104 +34,205 @@ class value_transitioner final {
 
     value_transitioner(value_type_t current_value);
     value_transitioner(const value_transitioner &other) = delete;
-    value_transitioner(value_transitioner &&other) = delete;
+    value_transitioner(value_transitioner &&other) = default;
     ~value_transitioner();
 
     value_transitioner &operator=(const value_transitioner &other) = delete;
-    value_transitioner &operator=(value_transitioner &&other) = delete;
+    value_transitioner &operator=(value_transitioner &&other);
 
     template<typename Callable>
     value_transitioner &start_transition_thread(Callable callable,
                                                 std::chrono::milliseconds period = std::chrono::milliseconds(100));
 
+    // Every changed value is passed to the callable by the push thread of the transition_engine, at most once per
+    // interval. If the callable is behind, the intermediate values are skipped and only the latest one is passed. Has
+    // to be set before the transition is started
+    template<typename Callable>
+    value_transitioner &push_changes_to(Callable callable, std::chrono::milliseconds min_interval);
+
     value_transitioner &target_value(value_type_t new_target);
     value_type_t current_value() const;
 
    private:
-    template<typename Callable>
-    void do_transitions(Callable transition_step);
-
-    mutable std::mutex m_instance_mutex;
-    mutable std::recursive_mutex m_value_mutex;
-    std::thread m_transition_thread;
-    std::condition_variable m_wake_up;
-    std::chrono::milliseconds m_period = std::chrono::milliseconds(100);
-    std::atomic_bool m_exit_thread;
-
-    value_type_t m_target_value;
-    value_type_t m_current_value;
+    using transition_step_type =
+        std::function<transition_state(std::chrono::milliseconds, value_type_t &, const value_type_t &)>;
+    using push_type = std::function<void(const value_type_t &)>;
+    using evaluator_type = std::function<value_type_t(transition_engine::clock_type::time_point)>;
+
+    // Lives on the heap, so the engine can keep a pointer to it, when the transitioner is moved
+    struct transition_data {
+        transition_data(value_type_t current_value);
+
+        void activate_transition();
+        std::optional<transition_engine::clock_type::time_point> do_transition_step();
+        void push_latest_value();
+        void publish_evaluator(bool is_finished);
+
+        std::mutex m_instance_mutex;
+        std::chrono::milliseconds m_period = std::chrono::milliseconds(100);
+        transition_step_type m_transition_step;
+        std::function<evaluator_type()> m_copy_evaluator;
+        push_type m_push;
+        std::chrono::milliseconds m_min_push_interval{0};
+        transition_engine::clock_type::time_point m_last_step;
+        bool m_is_active = false;
+
+        value_type_t m_target_value;
+        // Only modified by the steps of the transition, the readers use the published snapshot
+        value_type_t m_working_value;
+        std::shared_ptr<const value_type_t> m_current_value;
+        std::shared_ptr<const evaluator_type> m_current_evaluator;
+
+        std::shared_ptr<transition_engine> m_engine;
+        transition_engine::transition_id m_transition_id;
+    };
+
+    void deactivate();
+
+    std::unique_ptr<transition_data> m_data;
 };
 
+template<typename ValueType>
+value_transitioner<ValueType>::transition_data::transition_data(value_type_t current_value)
+    : m_target_value(current_value),
+      m_working_value(current_value),
+      m_current_value(std::make_shared<const value_type_t>(current_value)),
+      m_engine(transition_engine::instance()),
+      m_transition_id(m_engine->create_id()) {}
+
 template<typename ValueType>
 value_transitioner<ValueType>::value_transitioner(value_type_t current_value)
-    : m_current_value(current_value), m_target_value(current_value), m_exit_thread(false) {}
+    : m_data(std::make_unique<transition_data>(current_value)) {}
 
+// The first step is executed right away, like the step of a newly started transition thread
 template<typename ValueType>
 template<typename Callable>
 auto value_transitioner<ValueType>::start_transition_thread(Callable callable, std::chrono::milliseconds period)
     -> value_transitioner & {
-    std::lock_guard<std::mutex> instance_guard{m_instance_mutex};
-    m_period = period;
+    std::lock_guard<std::mutex> instance_guard{m_data->m_instance_mutex};
+    m_data->m_period = period;
+    m_data->m_transition_step = callable;
+
+    if constexpr (is_evaluable_transition<Callable, value_type_t>::value) {
+        // The copy is made with m_instance_mutex locked, after the step has updated the state of the transition
+        m_data->m_copy_evaluator = [data = m_data.get()]() -> evaluator_type {
+            return [transition = *data->m_transition_step.template target<Callable>()](auto point_in_time) {
+                return static_cast<value_type_t>(transition.value_at(point_in_time));
+            };
+        };
+    }
+
+    m_data->activate_transition();
+    return *this;
+}
 
-    m_transition_thread = std::thread([this, callable]() { do_transitions(callable); });
+template<typename ValueType>
+template<typename Callable>
+auto value_transitioner<ValueType>::push_changes_to(Callable callable, std::chrono::milliseconds min_interval)
+    -> value_transitioner & {
+    std::lock_guard<std::mutex> instance_guard{m_data->m_instance_mutex};
+    m_data->m_push = callable;
+    m_data->m_min_push_interval = min_interval;
     return *this;
 }
 
 template<typename ValueType>
 value_transitioner<ValueType>::~value_transitioner() {
-    m_exit_thread.store(true);
-    m_wake_up.notify_all();
+    deactivate();
+}
 
-    if (m_transition_thread.joinable()) {
-        m_transition_thread.join();
+template<typename ValueType>
+auto value_transitioner<ValueType>::operator=(value_transitioner &&other) -> value_transitioner & {
+    if (this != &other) {
+        deactivate();
+        m_data = std::move(other.m_data);
     }
+
+    return *this;
 }
 
+// Moved from transitioners don't have any data left
 template<typename ValueType>
-auto value_transitioner<ValueType>::target_value(value_type_t target_value) -> value_transitioner<value_type_t> & {
-    {
-        std::lock_guard<std::mutex> instance_guard{m_instance_mutex};
-        m_target_value = target_value;
+void value_transitioner<ValueType>::deactivate() {
+    if (m_data != nullptr) {
+        m_data->m_engine->deactivate(m_data->m_transition_id);
     }
-    m_wake_up.notify_all();
+}
+
+template<typename ValueType>
+auto value_transitioner<ValueType>::target_value(value_type_t target_value) -> value_transitioner<value_type_t> & {
+    std::lock_guard<std::mutex> instance_guard{m_data->m_instance_mutex};
+    m_data->m_target_value = target_value;
+
+    m_data->activate_transition();
     return *this;
 }
 
 template<typename ValueType>
 auto value_transitioner<ValueType>::current_value() const -> value_type_t {
-    std::lock_guard<std::recursive_mutex> value_guard{m_value_mutex};
+    if (auto evaluator = std::atomic_load(&m_data->m_current_evaluator); evaluator != nullptr) {
+        return (*evaluator)(transition_engine::clock_type::now());
+    }
 
-    return m_current_value;
+    return *std::atomic_load(&m_data->m_current_value);
 }
 
+// Has to be called with m_instance_mutex locked
 template<typename ValueType>
-template<typename Callable>
-void value_transitioner<ValueType>::do_transitions(Callable transition_step) {
-    using namespace std::chrono;
+void value_transitioner<ValueType>::transition_data::activate_transition() {
+    if (m_is_active || !m_transition_step) {
+        return;
+    }
 
-    milliseconds then = duration_cast<milliseconds>(steady_clock::now().time_since_epoch());
-    milliseconds delta_time{0};
+    m_is_active = true;
+    m_last_step = transition_engine::clock_type::now();
+    m_engine->activate(m_transition_id, [this]() { return do_transition_step(); }, m_last_step);
+}
 
-    while (!m_exit_thread.load()) {
-        std::unique_lock<std::mutex> instance_guard{m_instance_mutex};
+template<typename ValueType>
+auto value_transitioner<ValueType>::transition_data::do_transition_step()
+    -> std::optional<transition_engine::clock_type::time_point> {
+    using namespace std::chrono;
 
-        delta_time = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()) - then;
+    std::lock_guard<std::mutex> instance_guard{m_instance_mutex};
 
-        transition_state current_state;
-        auto time_transition_step_call = steady_clock::now();
+    auto time_transition_step_call = transition_engine::clock_type::now();
+    auto delta_time = duration_cast<milliseconds>(time_transition_step_call - m_last_step);
+    auto current_state = m_transition_step(delta_time, m_working_value, m_target_value);
 
-        // Maybe check return value, to check if the transition is already done
-        {
-            std::lock_guard<std::recursive_mutex> value_guard{m_value_mutex};
-            current_state = transition_step(delta_time, m_current_value, m_target_value);
-        }
+    if (current_state != transition_state::value_did_not_change) {
+        std::atomic_store(&m_current_value, std::make_shared<const value_type_t>(m_working_value));
 
-        if (current_state != transition_state::finished_transition) {
-            then = duration_cast<milliseconds>(steady_clock::now().time_since_epoch());
-            m_wake_up.wait_until(instance_guard, time_transition_step_call + m_period);
-        } else {
-            m_wake_up.wait(instance_guard);
-            then = duration_cast<milliseconds>(steady_clock::now().time_since_epoch());
+        if (m_push) {
+            m_engine->request_push(m_transition_id, [this]() { push_latest_value(); }, m_min_push_interval);
         }
     }
+
+    publish_evaluator(current_state == transition_state::finished_transition);
+
+    m_last_step = transition_engine::clock_type::now();
+
+    if (current_state == transition_state::finished_transition) {
+        m_is_active = false;
+        return {};
+    }
+
+    return time_transition_step_call + m_period;
+}
+
+// Has to be called with m_instance_mutex locked, finished transitions are read from the published value again
+template<typename ValueType>
+void value_transitioner<ValueType>::transition_data::publish_evaluator(bool is_finished) {
+    if (!m_copy_evaluator) {
+        return;
+    }
+
+    std::atomic_store(&m_current_evaluator,
+                      is_finished ? nullptr : std::make_shared<const evaluator_type>(m_copy_evaluator()));
+}
+
+// Called by the push thread
+template<typename ValueType>
+void value_transitioner<ValueType>::transition_data::push_latest_value() {
+    m_push(*std::atomic_load(&m_current_value));
 }
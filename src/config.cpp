@@ -54,7 +54,13 @@ nlohmann::json config::find(const std::string &value) const {
     if (!m_is_valid) {
         return nlohmann::json{};
     }
-    return m_config[value];
+
+    // operator[] of a const json object requires the key to exist
+    if (auto result = m_config.find(value); result != m_config.cend()) {
+        return *result;
+    }
+
+    return nlohmann::json{};
 }
 
 void swap(config &lhs, config &rhs) { lhs.swap(rhs); }
@@ -17,6 +17,8 @@ void manual_control_view::create_gui() {
     lv_page_set_sb_mode(m_page, LV_SB_MODE_AUTO);
     lv_page_set_scrl_layout(m_page, LV_LAYOUT_COL_L);
 
+    m_output_changes = output_change_bus::subscribe();
+
     for (auto current_id : outputs::get_ids()) {
         m_manual_overrides.emplace_back(m_page, current_id);
         lv_page_glue_obj(m_manual_overrides.back().container(), true);
@@ -33,6 +35,20 @@ page_event manual_control_view::update_contents() {
 }
 
 void manual_control_view::update_override_elements() {
+    while (auto change = m_output_changes->try_pop()) {
+        auto changed_id = outputs::id_of(change->m_output);
+
+        if (!changed_id.has_value()) {
+            continue;
+        }
+
+        for (auto &current_output_view : m_manual_overrides) {
+            if (current_output_view.output_id() == *changed_id) {
+                current_output_view.show_value(change->m_value);
+            }
+        }
+    }
+
     for (auto &current_output_view : m_manual_overrides) {
         current_output_view.update_gui();
     }
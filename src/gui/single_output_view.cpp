@@ -54,4 +54,14 @@ void single_output_view::create_gui(lv_obj_t *parent) {
 
 void single_output_view::update_gui() {}
 
+void single_output_view::show_value(const output_value &value) {
+    if (m_override_value == nullptr) {
+        return;
+    }
+
+    single_output_view_controller::set_value_to_current_state(m_override_value, value);
+}
+
+const std::string &single_output_view::output_id() const { return m_output_id; }
+
 lv_obj_t *single_output_view::container() { return m_container; }
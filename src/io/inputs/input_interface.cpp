@@ -0,0 +1,30 @@
+#include "io/inputs/input_interface.h"
+#include "logger.h"
+
+void input_interface::on_event(event_callback callback) { m_on_event = std::move(callback); }
+
+void input_interface::notify(const input_event &event) const {
+    if (m_on_event) {
+        m_on_event(event);
+    }
+}
+
+std::shared_ptr<input_factory> input_factory::instance() { return singleton<input_factory>::instance(); }
+
+std::unique_ptr<input_interface> input_factory::deserialize(const std::string &type, const json &description) {
+    auto lock = retrieve_instance_lock();
+    auto input_factory_instance = instance();
+
+    if (input_factory_instance == nullptr) {
+        return nullptr;
+    }
+
+    auto result = input_factory_instance->m_factories.find(type);
+
+    if (result == input_factory_instance->m_factories.cend()) {
+        logger::instance()->critical("Input type {} couldn't be found", type);
+        return nullptr;
+    }
+
+    return result->second(description);
+}
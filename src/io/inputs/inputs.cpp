@@ -0,0 +1,90 @@
+#include "io/inputs/inputs.h"
+
+#include "logger.h"
+
+bool inputs::add_input(json &input_description) {
+    std::unique_lock<std::shared_mutex> list_guard{_list_mutex};
+    auto logger_instance = logger::instance();
+
+    json id_entry = input_description["id"];
+    json type_entry = input_description["type"];
+    json description_entry = input_description["description"];
+
+    if (id_entry.is_null() || type_entry.is_null() || description_entry.is_null()) {
+        logger_instance->critical("A needed entry in a input entry was missing {} {} {}",
+                                  id_entry.is_null() ? "id" : "", type_entry.is_null() ? "type" : "",
+                                  description_entry.is_null() ? "description" : "");
+        return false;
+    }
+
+    if (!id_entry.is_string() || !type_entry.is_string()) {
+        logger_instance->critical("The id or the type of an input entry is not a string");
+        return false;
+    }
+
+    std::string id = id_entry.get<std::string>();
+
+    if (_inputs.find(id) != _inputs.cend()) {
+        logger_instance->critical("The id {} for an input entry is already in use", id);
+        return false;
+    }
+
+    if (!description_entry.is_object()) {
+        logger_instance->critical("The description entry for the input entry with the id {} is not an object", id);
+        return false;
+    }
+
+    auto created_input = input_factory::deserialize(type_entry.get<std::string>(), description_entry);
+
+    if (!created_input) {
+        logger_instance->critical("The input with the id {} couldn't be created", id);
+        return false;
+    }
+
+    created_input->on_event([id](const input_event &event) { dispatch_event(id, event); });
+    _inputs.emplace(id, std::move(created_input));
+    return true;
+}
+
+void inputs::dispatch_event(const input_id &id, const input_event &event) {
+    logger::instance()->info("Input {} changed", id);
+
+    std::lock_guard<std::mutex> listeners_guard{_listeners_mutex};
+
+    for (const auto &current_listener : _listeners) {
+        current_listener(id, event);
+    }
+}
+
+bool inputs::is_valid_id(const input_id &id) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+    return _inputs.find(id) != _inputs.cend();
+}
+
+std::optional<output_value> inputs::read_value(const input_id &id) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+
+    if (auto result = _inputs.find(id); result != _inputs.cend()) {
+        return result->second->read_value();
+    }
+
+    return {};
+}
+
+std::vector<input_id> inputs::get_ids() {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+
+    std::vector<input_id> ids;
+    ids.reserve(_inputs.size());
+
+    for (const auto &[id, input] : _inputs) {
+        ids.emplace_back(id);
+    }
+
+    return ids;
+}
+
+void inputs::add_listener(listener new_listener) {
+    std::lock_guard<std::mutex> listeners_guard{_listeners_mutex};
+    _listeners.emplace_back(std::move(new_listener));
+}
@@ -3,68 +3,516 @@
 #include <linux/can.h>
 #include <linux/can/raw.h>
 #include <net/if.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 
-#include <climits>
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <iterator>
+#include <vector>
 
 #include "logger.h"
 
-std::shared_ptr<can> can::instance(const std::filesystem::path &can_path) {
+std::shared_ptr<can> can::instance(const std::filesystem::path &can_interface) {
     std::lock_guard<std::mutex> instance_guard{_instance_mutex};
 
-    if (_instance) {
-        return _instance;
+    std::string interface_name = can_interface.filename().string();
+
+    if (auto instance = _instances.find(interface_name); instance != _instances.cend()) {
+        return instance->second;
     }
 
     auto logger_instance = logger::instance();
 
     ifreq ifr;
-    std::strncpy(ifr.ifr_name, can_path.c_str(), IFNAMSIZ - 1);
+    std::strncpy(ifr.ifr_name, interface_name.c_str(), IFNAMSIZ - 1);
     // Definetly set terminating null character, so if the string is too big the terminating \0 is set, to prevent
     // overflows
     ifr.ifr_name[IFNAMSIZ - 1] = '\0';
     ifr.ifr_ifindex = if_nametoindex(ifr.ifr_name);
 
     if (!ifr.ifr_ifindex) {
-        logger_instance->critical("Couldn't find the can bus device {}", can_path.c_str());
+        logger_instance->critical("Couldn't find the can bus device {}", interface_name);
         return nullptr;
     }
 
     // TODO: Find out why this is an error in valgrind
     sockaddr_can addr{.can_family = AF_CAN, .can_ifindex = ifr.ifr_ifindex};
-    int socket_handle = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    int socket_handle = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
 
-    if (socket_handle == 0) {
-        logger_instance->critical("Couldn't open a socket for the can device {}", can_path.c_str());
+    if (socket_handle == -1) {
+        logger_instance->critical("Couldn't open a socket for the can device {}", interface_name);
         return nullptr;
     }
 
+    // Nobody is interested in any frame yet, so the kernel shouldn't deliver any, receive_from extends the filter
+    if (setsockopt(socket_handle, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0) == -1) {
+        logger_instance->warn("Couldn't set the receive filter of the can device {}", interface_name);
+    }
+
+    int enable_timestamps = 1;
+    if (setsockopt(socket_handle, SOL_SOCKET, SO_TIMESTAMP, &enable_timestamps, sizeof(enable_timestamps)) == -1) {
+        logger_instance->warn("Couldn't enable the receive timestamps of the can device {}", interface_name);
+    }
+
+    // Fd frames can only be sent, if the interface has the mtu of fd frames
+    bool supports_fd_frames = false;
+    int enable_fd_frames = 1;
+    if (ioctl(socket_handle, SIOCGIFMTU, &ifr) == 0 && ifr.ifr_mtu == CANFD_MTU) {
+        supports_fd_frames =
+            setsockopt(socket_handle, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable_fd_frames, sizeof(enable_fd_frames)) == 0;
+    }
+
     if (bind(socket_handle, (sockaddr *)&addr, sizeof(addr)) < 0) {
-        logger_instance->critical("Couldn't bind the socket for the can device {}", can_path.c_str());
+        logger_instance->critical("Couldn't bind the socket for the can device {}", interface_name);
+        close(socket_handle);
         return nullptr;
     }
 
-    return (_instance = std::shared_ptr<can>(new can(socket_handle)));
+    int retry_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (retry_timer_fd == -1) {
+        logger_instance->critical("Couldn't create the retry timer of the can device {}", interface_name);
+        close(socket_handle);
+        return nullptr;
+    }
+
+    auto created_instance =
+        std::shared_ptr<can>(new can(interface_name, socket_handle, retry_timer_fd, supports_fd_frames));
+
+    // The instance is only referenced weakly by the event loop, the registry keeps it alive
+    std::weak_ptr<can> weak_instance = created_instance;
+    if (!created_instance->m_event_loop->watch(socket_handle, EPOLLIN, [weak_instance](uint32_t events) {
+            if (auto current_instance = weak_instance.lock(); current_instance != nullptr) {
+                current_instance->handle_events(events);
+            }
+        })) {
+        logger_instance->critical("Couldn't watch the socket of the can device {}", interface_name);
+        return nullptr;
+    }
+
+    if (!created_instance->m_event_loop->watch(retry_timer_fd, EPOLLIN, [weak_instance](uint32_t) {
+            if (auto current_instance = weak_instance.lock(); current_instance != nullptr) {
+                current_instance->retry_time_passed();
+            }
+        })) {
+        logger_instance->critical("Couldn't watch the retry timer of the can device {}", interface_name);
+        return nullptr;
+    }
+
+    _instances[interface_name] = created_instance;
+    return created_instance;
 }
 
-can::can(int socket_handle) : m_socket_handle(socket_handle) {}
+can::can(std::string interface_name, int socket_handle, int retry_timer_fd, bool supports_fd_frames)
+    : m_interface_name(std::move(interface_name)),
+      m_socket_handle(socket_handle),
+      m_retry_timer_fd(retry_timer_fd),
+      m_supports_fd_frames(supports_fd_frames),
+      m_event_loop(io_event_loop::instance()) {}
 
 can::~can() {
     if (m_socket_handle != -1) {
+        m_event_loop->unwatch(m_socket_handle);
         close(m_socket_handle);
     }
+
+    if (m_retry_timer_fd != -1) {
+        m_event_loop->unwatch(m_retry_timer_fd);
+        close(m_retry_timer_fd);
+    }
 }
 
+const std::string &can::interface_name() const { return m_interface_name; }
+
+bool can::supports_fd_frames() const { return m_supports_fd_frames; }
+
 can_error_code can::send(const can_object_identifier &identifier, uint64_t data) {
+    can_message message{identifier, sizeof(data)};
+    std::memcpy(message.m_data.data(), (char *)&data, sizeof(data));
+
+    return send(message);
+}
+
+can_error_code can::send(const can_message &message, can_send_mode mode) {
+    return send(std::vector<can_message>{message}, mode).front();
+}
+
+std::vector<can_error_code> can::send(const std::vector<can_message> &messages, can_send_mode mode) {
+    std::vector<can_error_code> results(messages.size(), can_error_code::send_error);
+    std::vector<canfd_frame> frames;
+    std::vector<size_t> frame_indices;
+
+    frames.reserve(messages.size());
+    frame_indices.reserve(messages.size());
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (auto frame = frame_of(messages[i]); frame.has_value()) {
+            frames.emplace_back(*frame);
+            frame_indices.emplace_back(i);
+        }
+    }
+
+    std::vector<can_error_code> frame_results(frames.size(), can_error_code::send_error);
+    size_t written_frames = 0;
+
+    std::lock_guard<std::mutex> pending_frames_guard{m_pending_frames_mutex};
+
+    // While frames are queued, new frames are queued as well, so all of them are sent in the order of their priority
+    if (m_pending_frames.empty()) {
+        written_frames = write_frames(frames.data(), frames.size(), frame_results.data());
+    }
+
+    for (size_t i = written_frames; i < frames.size(); ++i) {
+        auto &pending_frames_of_identifier = m_pending_frames[frames[i].can_id];
+
+        // Only the newest payload of an identifier is of interest, so it replaces the queued ones. Frames, which are
+        // sent in order (e.g. the frames of a segmented transfer), are kept, only the frames after them are replaced
+        while (mode == can_send_mode::coalesce && !pending_frames_of_identifier.empty() &&
+               pending_frames_of_identifier.back().m_mode == can_send_mode::coalesce) {
+            pending_frames_of_identifier.pop_back();
+            --m_number_of_pending_frames;
+            ++m_coalesced_frames;
+        }
+
+        if (m_number_of_pending_frames < _max_pending_frames) {
+            pending_frames_of_identifier.push_back(pending_frame{frames[i], mode});
+            ++m_number_of_pending_frames;
+        } else {
+            logger::instance()->warn("The transmit queue of the can device {} is full", m_interface_name);
+
+            if (pending_frames_of_identifier.empty()) {
+                m_pending_frames.erase(frames[i].can_id);
+            }
+
+            continue;
+        }
+
+        frame_results[i] = can_error_code::ok;
+    }
+
+    if (written_frames < frames.size()) {
+        wait_for_writability();
+    }
+
+    for (size_t i = 0; i < frame_indices.size(); ++i) {
+        results[frame_indices[i]] = frame_results[i];
+    }
+
+    return results;
+}
+
+std::optional<canfd_frame> can::frame_of(const can_message &message) const {
+    // The lengths fd frames can have, shorter payloads are padded to the next one
+    static constexpr std::array<uint8_t, 16> fd_frame_lengths{0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+    if (message.m_length > CANFD_MAX_DLEN || (message.m_length > CAN_MAX_DLEN && !m_supports_fd_frames)) {
+        logger::instance()->warn("The can device {} can't send {} bytes in one frame", m_interface_name,
+                                 message.m_length);
+        return {};
+    }
+
     canfd_frame frame;
     std::memset((char *)&frame, 0, sizeof(frame));
 
-    frame.can_id = (canid_t)identifier;
-    frame.len = sizeof(data) / CHAR_BIT;
-    std::memcpy(frame.data, (char *)&data, sizeof(data));
+    frame.can_id = (canid_t)message.m_identifier;
+    frame.len = *std::lower_bound(fd_frame_lengths.cbegin(), fd_frame_lengths.cend(), message.m_length);
+    std::memcpy(frame.data, message.m_data.data(), message.m_length);
+
+    return frame;
+}
+
+bool can::receive_from(const can_object_identifier &identifier) {
+    std::lock_guard<std::mutex> receive_guard{m_receive_mutex};
+
+    if (m_received_messages.find(identifier) != m_received_messages.cend()) {
+        return true;
+    }
+
+    m_received_messages.emplace(identifier, ring_buffer<can_message, _received_messages_per_identifier>{});
+
+    if (!update_receive_filter()) {
+        m_received_messages.erase(identifier);
+        return false;
+    }
+
+    return true;
+}
+
+can_error_code can::receive(const can_object_identifier &identifier, uint64_t *data) const {
+    auto message = last_message(identifier);
+
+    if (!message.has_value() || data == nullptr) {
+        return can_error_code::receive_error;
+    }
+
+    *data = 0;
+    std::memcpy((char *)data, message->m_data.data(), std::min<size_t>(message->m_length, sizeof(*data)));
+    return can_error_code::ok;
+}
+
+std::optional<can_message> can::last_message(const can_object_identifier &identifier) const {
+    std::lock_guard<std::mutex> receive_guard{m_receive_mutex};
+
+    if (auto messages = m_received_messages.find(identifier); messages != m_received_messages.cend()) {
+        return messages->second.retrieve_last_element();
+    }
+
+    return {};
+}
+
+std::vector<can_message> can::received_messages(const can_object_identifier &identifier) const {
+    std::lock_guard<std::mutex> receive_guard{m_receive_mutex};
+    std::vector<can_message> result;
+
+    if (auto messages = m_received_messages.find(identifier); messages != m_received_messages.cend()) {
+        for (size_t i = 0; i < messages->second.size(); ++i) {
+            result.emplace_back(*messages->second.at(i));
+        }
+    }
+
+    return result;
+}
+
+bool can::add_receive_listener(const can_object_identifier &identifier, receive_callback callback) {
+    if (!receive_from(identifier)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> receive_guard{m_receive_mutex};
+    m_receive_listeners.emplace(identifier, std::move(callback));
+    return true;
+}
+
+bool can::update_receive_filter() {
+    if (m_received_messages.size() > CAN_RAW_FILTER_MAX) {
+        logger::instance()->critical("The can device {} can't receive from more than {} identifiers", m_interface_name,
+                                     CAN_RAW_FILTER_MAX);
+        return false;
+    }
+
+    std::vector<can_filter> filters;
+    filters.reserve(m_received_messages.size());
+
+    // Only standard data frames with exactly this identifier pass the filter
+    for (const auto &[current_identifier, messages] : m_received_messages) {
+        filters.push_back(can_filter{(canid_t)current_identifier, CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_SFF_MASK});
+    }
+
+    if (setsockopt(m_socket_handle, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                   filters.size() * sizeof(can_filter)) == -1) {
+        logger::instance()->critical("Couldn't update the receive filter of the can device {} : {}", m_interface_name,
+                                     errno);
+        return false;
+    }
+
+    return true;
+}
+
+void can::handle_events(uint32_t events) {
+    if (events & EPOLLIN) {
+        read_frames();
+    }
+
+    if (events & EPOLLOUT) {
+        write_pending_frames();
+    }
+
+    if (events & EPOLLERR) {
+        logger::instance()->warn("The socket of the can device {} reported an error", m_interface_name);
+    }
+}
+
+void can::read_frames() {
+    canfd_frame frame;
+    iovec frame_vector{&frame, sizeof(frame)};
+    alignas(cmsghdr) char control_buffer[CMSG_SPACE(sizeof(timeval))];
+    std::vector<receive_callback> listeners;
+
+    // All available frames are read at once, so the event loop wakes up less often
+    while (true) {
+        msghdr message_header{};
+        message_header.msg_iov = &frame_vector;
+        message_header.msg_iovlen = 1;
+        message_header.msg_control = control_buffer;
+        message_header.msg_controllen = sizeof(control_buffer);
+
+        ssize_t read_bytes = recvmsg(m_socket_handle, &message_header, 0);
+
+        if (read_bytes == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                logger::instance()->warn("Couldn't read from the can device {} : {}", m_interface_name, errno);
+            }
+
+            if (errno != EINTR) {
+                return;
+            }
+
+            continue;
+        }
+
+        if ((read_bytes != CAN_MTU && read_bytes != CANFD_MTU) || (frame.can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG))) {
+            continue;
+        }
+
+        can_message message{can_object_identifier(frame.can_id & CAN_EFF_MASK),
+                            std::min<uint8_t>(frame.len, sizeof(frame.data)), {}, std::chrono::system_clock::now()};
+        std::memcpy(message.m_data.data(), frame.data, message.m_length);
+
+        // Use the time the kernel received the frame, if it is available
+        for (auto current_header = CMSG_FIRSTHDR(&message_header); current_header != nullptr;
+             current_header = CMSG_NXTHDR(&message_header, current_header)) {
+            if (current_header->cmsg_level == SOL_SOCKET && current_header->cmsg_type == SO_TIMESTAMP) {
+                timeval receive_time;
+                std::memcpy(&receive_time, CMSG_DATA(current_header), sizeof(receive_time));
+                message.m_timestamp = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::seconds(receive_time.tv_sec) + std::chrono::microseconds(receive_time.tv_usec)));
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> receive_guard{m_receive_mutex};
+
+            if (auto messages = m_received_messages.find(message.m_identifier);
+                messages != m_received_messages.cend()) {
+                messages->second.put(message);
+            }
+
+            auto [begin, end] = m_receive_listeners.equal_range(message.m_identifier);
+            std::transform(begin, end, std::back_inserter(listeners),
+                           [](const auto &current_listener) { return current_listener.second; });
+        }
+
+        // The listeners are called without the receive mutex, so they can access the received messages or send frames
+        for (const auto &current_listener : listeners) {
+            current_listener(message);
+        }
+
+        listeners.clear();
+    }
+}
+
+size_t can::coalesced_frames() const {
+    std::lock_guard<std::mutex> pending_frames_guard{m_pending_frames_mutex};
+    return m_coalesced_frames;
+}
+
+void can::retry_time_passed() {
+    uint64_t expirations = 0;
+
+    if (read(m_retry_timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+
+    write_pending_frames();
+}
+
+void can::write_pending_frames() {
+    std::lock_guard<std::mutex> pending_frames_guard{m_pending_frames_mutex};
+    std::vector<canfd_frame> frames;
+    std::vector<can_error_code> results;
+
+    while (!m_pending_frames.empty()) {
+        size_t number_of_frames = std::min(m_number_of_pending_frames, _max_frames_per_write);
+        frames.clear();
+        results.assign(number_of_frames, can_error_code::send_error);
+
+        // The map is ordered by the identifier, so the frames with the highest priority are sent first
+        for (auto current_frames = m_pending_frames.cbegin(); frames.size() < number_of_frames; ++current_frames) {
+            for (size_t i = 0; i < current_frames->second.size() && frames.size() < number_of_frames; ++i) {
+                frames.emplace_back(current_frames->second[i].m_frame);
+            }
+        }
+
+        size_t written_frames = write_frames(frames.data(), frames.size(), results.data());
+        auto dropped_frames =
+            std::count(results.cbegin(), results.cbegin() + written_frames, can_error_code::send_error);
+
+        if (dropped_frames > 0) {
+            logger::instance()->warn("Dropped {} queued frames of the can device {}", dropped_frames, m_interface_name);
+        }
+
+        for (size_t frames_to_remove = written_frames; frames_to_remove > 0;) {
+            auto &frames_of_identifier = m_pending_frames.begin()->second;
+            size_t removed_frames = std::min(frames_to_remove, frames_of_identifier.size());
+
+            frames_of_identifier.erase(frames_of_identifier.begin(), frames_of_identifier.begin() + removed_frames);
+            frames_to_remove -= removed_frames;
+            m_number_of_pending_frames -= removed_frames;
+
+            if (frames_of_identifier.empty()) {
+                m_pending_frames.erase(m_pending_frames.begin());
+            }
+        }
+
+        if (written_frames < number_of_frames) {
+            wait_for_writability();
+            return;
+        }
+    }
+
+    wait_for_writability();
+}
+
+void can::wait_for_writability() {
+    // ENOBUFS isn't followed by EPOLLOUT reliably, so the timer retries as well
+    itimerspec retry_timer{};
+    uint32_t events = EPOLLIN;
+
+    if (!m_pending_frames.empty()) {
+        retry_timer.it_value.tv_nsec = std::chrono::nanoseconds(_retry_interval).count();
+        events |= EPOLLOUT;
+    }
+
+    // Without queued frames the event loop doesn't have to wake up for writability
+    m_event_loop->modify(m_socket_handle, events);
+    timerfd_settime(m_retry_timer_fd, 0, &retry_timer, nullptr);
+}
+
+size_t can::write_frames(const canfd_frame *frames, size_t number_of_frames, can_error_code *results) {
+    std::array<iovec, _max_frames_per_write> frame_vectors;
+    std::array<mmsghdr, _max_frames_per_write> message_headers;
+    size_t handled_frames = 0;
+
+    while (handled_frames < number_of_frames) {
+        size_t frames_to_write = std::min(number_of_frames - handled_frames, _max_frames_per_write);
+
+        for (size_t i = 0; i < frames_to_write; ++i) {
+            const auto &current_frame = frames[handled_frames + i];
+            // Classic frames are sent with the smaller mtu, so interfaces without fd support accept them
+            frame_vectors[i] = iovec{const_cast<canfd_frame *>(&current_frame),
+                                     current_frame.len > CAN_MAX_DLEN ? CANFD_MTU : CAN_MTU};
+            message_headers[i] = mmsghdr{};
+            message_headers[i].msg_hdr.msg_iov = &frame_vectors[i];
+            message_headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent_frames = sendmmsg(m_socket_handle, message_headers.data(), frames_to_write, MSG_DONTWAIT);
+
+        if (sent_frames > 0) {
+            std::fill(results + handled_frames, results + handled_frames + sent_frames, can_error_code::ok);
+            handled_frames += sent_frames;
+            continue;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+            return handled_frames;
+        }
+
+        // Only the first frame failed, the following ones are tried again
+        logger::instance()->warn("Couldn't send a frame with the can device {} : {}", m_interface_name, errno);
+        results[handled_frames] = can_error_code::send_error;
+        ++handled_frames;
+    }
 
-    return write(m_socket_handle, &frame, CAN_MTU) == CAN_MTU ? can_error_code::ok : can_error_code::send_error;
+    return handled_frames;
 }
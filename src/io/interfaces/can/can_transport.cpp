@@ -0,0 +1,210 @@
+#include "io/interfaces/can/can_transport.h"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "logger.h"
+
+std::shared_ptr<can_transport> can_transport::create(std::shared_ptr<can> can_instance,
+                                                     can_object_identifier transmit_identifier,
+                                                     can_object_identifier flow_control_identifier) {
+    if (!can_instance) {
+        return nullptr;
+    }
+
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (timer_fd == -1) {
+        logger::instance()->critical("Couldn't create the timer of the can transport {}", (int)transmit_identifier);
+        return nullptr;
+    }
+
+    // The constructor is private, so make_shared can't be used
+    auto created_transport =
+        std::shared_ptr<can_transport>(new can_transport(std::move(can_instance), transmit_identifier, timer_fd));
+
+    if (!created_transport->m_event_loop->watch(timer_fd, EPOLLIN,
+                                                [transport = created_transport.get()](uint32_t) {
+                                                    transport->timer_expired();
+                                                })) {
+        return nullptr;
+    }
+
+    // The can instance can't remove listeners, so it only keeps a weak reference to the transport
+    std::weak_ptr<can_transport> weak_transport = created_transport;
+    if (!created_transport->m_can_instance->add_receive_listener(
+            flow_control_identifier, [weak_transport](const can_message &message) {
+                if (auto current_transport = weak_transport.lock(); current_transport != nullptr) {
+                    current_transport->handle_flow_control(message);
+                }
+            })) {
+        logger::instance()->critical("Couldn't receive the flow control frames of the can transport {}",
+                                     (int)transmit_identifier);
+        return nullptr;
+    }
+
+    return created_transport;
+}
+
+can_transport::can_transport(std::shared_ptr<can> can_instance, can_object_identifier transmit_identifier,
+                             int timer_fd)
+    : m_can_instance(std::move(can_instance)),
+      m_transmit_identifier(transmit_identifier),
+      m_timer_fd(timer_fd),
+      m_event_loop(io_event_loop::instance()) {}
+
+can_transport::~can_transport() {
+    m_event_loop->unwatch(m_timer_fd);
+    close(m_timer_fd);
+}
+
+std::future<bool> can_transport::send(std::vector<uint8_t> payload) {
+    std::promise<bool> result;
+    auto result_future = result.get_future();
+
+    if (payload.size() > isotp_transfer::max_payload_size) {
+        logger::instance()->warn("The payload for the can transport {} is too large", (int)m_transmit_identifier);
+        result.set_value(false);
+        return result_future;
+    }
+
+    std::lock_guard<std::mutex> transfer_guard{m_transfer_mutex};
+
+    if (!m_next_payload.has_value()) {
+        m_next_payload.emplace();
+    }
+
+    m_next_payload->m_payload = std::move(payload);
+    m_next_payload->m_results.emplace_back(std::move(result));
+
+    if (!m_transfer.has_value()) {
+        start_next_transfer();
+    }
+
+    return result_future;
+}
+
+bool can_transport::is_busy() const {
+    std::lock_guard<std::mutex> transfer_guard{m_transfer_mutex};
+    return m_transfer.has_value() || m_next_payload.has_value();
+}
+
+void can_transport::on_transfer_finished(completion_callback callback) {
+    std::lock_guard<std::mutex> transfer_guard{m_transfer_mutex};
+    m_on_transfer_finished = std::move(callback);
+}
+
+void can_transport::handle_flow_control(const can_message &message) {
+    std::lock_guard<std::mutex> transfer_guard{m_transfer_mutex};
+
+    // Flow control frames are only expected after the first frame and after a block
+    if (!m_transfer.has_value() ||
+        m_transfer->state() != isotp_transfer::transfer_state::waiting_for_flow_control) {
+        return;
+    }
+
+    m_transfer->handle_flow_control(message);
+
+    if (m_transfer->state() == isotp_transfer::transfer_state::waiting_for_flow_control) {
+        // The receiver asked to wait, so it gets another timeout
+        arm_timer(_flow_control_timeout);
+        return;
+    }
+
+    continue_transfer();
+    start_next_transfer();
+}
+
+void can_transport::timer_expired() {
+    uint64_t expirations = 0;
+
+    if (read(m_timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> transfer_guard{m_transfer_mutex};
+
+    if (!m_transfer.has_value()) {
+        return;
+    }
+
+    if (m_transfer->state() == isotp_transfer::transfer_state::waiting_for_flow_control) {
+        logger::instance()->warn("The receiver of the can transport {} didn't answer in time",
+                                 (int)m_transmit_identifier);
+        m_transfer->abort();
+    }
+
+    continue_transfer();
+    start_next_transfer();
+}
+
+void can_transport::start_next_transfer() {
+    while (!m_transfer.has_value() && m_next_payload.has_value()) {
+        m_transfer.emplace(m_transmit_identifier, std::move(m_next_payload->m_payload));
+        m_transfer_results = std::move(m_next_payload->m_results);
+        m_next_payload.reset();
+
+        auto first_frame = m_transfer->start();
+
+        if (m_transfer->state() != isotp_transfer::transfer_state::failed && !send_frames({first_frame})) {
+            m_transfer->abort();
+        }
+
+        continue_transfer();
+    }
+}
+
+void can_transport::continue_transfer() {
+    if (m_transfer->state() == isotp_transfer::transfer_state::sending && !send_frames(m_transfer->next_frames())) {
+        m_transfer->abort();
+    }
+
+    switch (m_transfer->state()) {
+        case isotp_transfer::transfer_state::sending:
+            arm_timer(m_transfer->separation_time());
+            break;
+        case isotp_transfer::transfer_state::waiting_for_flow_control:
+            arm_timer(_flow_control_timeout);
+            break;
+        default:
+            finish_transfer();
+            break;
+    }
+}
+
+void can_transport::finish_transfer() {
+    bool is_delivered = m_transfer->state() == isotp_transfer::transfer_state::finished;
+
+    arm_timer(std::chrono::microseconds(0));
+    m_transfer.reset();
+
+    for (auto &current_result : m_transfer_results) {
+        current_result.set_value(is_delivered);
+    }
+
+    m_transfer_results.clear();
+
+    if (m_on_transfer_finished) {
+        m_on_transfer_finished(is_delivered);
+    }
+}
+
+bool can_transport::send_frames(const std::vector<can_message> &frames) {
+    // Every frame of a transfer has to arrive, so the frames mustn't be coalesced in the transmit queue
+    auto results = m_can_instance->send(frames, can_send_mode::in_order);
+
+    return std::all_of(results.cbegin(), results.cend(),
+                       [](const auto &current_result) { return current_result == can_error_code::ok; });
+}
+
+void can_transport::arm_timer(std::chrono::microseconds timeout) {
+    // A zero timeout disarms the timer
+    itimerspec timer_value{};
+    timer_value.it_value.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(timeout).count();
+    timer_value.it_value.tv_nsec = std::chrono::nanoseconds(timeout % std::chrono::seconds(1)).count();
+
+    timerfd_settime(m_timer_fd, 0, &timer_value, nullptr);
+}
@@ -0,0 +1,135 @@
+#include "io/interfaces/can/isotp_transfer.h"
+
+#include <algorithm>
+
+namespace isotp_frame_types {
+    constexpr uint8_t single_frame = 0x00;
+    constexpr uint8_t first_frame = 0x10;
+    constexpr uint8_t consecutive_frame = 0x20;
+    constexpr uint8_t flow_control = 0x30;
+}  // namespace isotp_frame_types
+
+namespace isotp_flow_status {
+    constexpr uint8_t continue_to_send = 0x0;
+    constexpr uint8_t wait = 0x1;
+    constexpr uint8_t overflow = 0x2;
+}  // namespace isotp_flow_status
+
+isotp_transfer::isotp_transfer(can_object_identifier identifier, std::vector<uint8_t> payload)
+    : m_identifier(identifier), m_payload(std::move(payload)) {
+    if (m_payload.size() > max_payload_size) {
+        logger::instance()->warn("A payload of {} bytes is too large for a segmented can transfer", m_payload.size());
+        m_state = transfer_state::failed;
+    }
+}
+
+can_message isotp_transfer::start() {
+    can_message message{m_identifier};
+
+    if (m_state == transfer_state::failed) {
+        return message;
+    }
+
+    // Payloads, which fit into one frame, don't need any flow control
+    if (m_payload.size() < _frame_size) {
+        message.m_data[0] = isotp_frame_types::single_frame | static_cast<uint8_t>(m_payload.size());
+        std::copy(m_payload.cbegin(), m_payload.cend(), message.m_data.begin() + 1);
+        message.m_length = static_cast<uint8_t>(m_payload.size() + 1);
+
+        m_sent_bytes = m_payload.size();
+        m_state = transfer_state::finished;
+        return message;
+    }
+
+    message.m_data[0] = isotp_frame_types::first_frame | static_cast<uint8_t>(m_payload.size() >> 8);
+    message.m_data[1] = static_cast<uint8_t>(m_payload.size() & 0xFF);
+    std::copy_n(m_payload.cbegin(), _frame_size - 2, message.m_data.begin() + 2);
+    message.m_length = _frame_size;
+
+    m_sent_bytes = _frame_size - 2;
+    m_state = transfer_state::waiting_for_flow_control;
+    return message;
+}
+
+void isotp_transfer::handle_flow_control(const can_message &message) {
+    if (m_state != transfer_state::waiting_for_flow_control || message.m_length < 3 ||
+        (message.m_data[0] & 0xF0) != isotp_frame_types::flow_control) {
+        return;
+    }
+
+    switch (message.m_data[0] & 0x0F) {
+        case isotp_flow_status::continue_to_send:
+            m_block_size = message.m_data[1];
+            m_frames_left_in_block = m_block_size;
+            m_separation_time = parse_separation_time(message.m_data[2]);
+            m_state = transfer_state::sending;
+            break;
+        case isotp_flow_status::wait:
+            if (++m_received_wait_frames > _max_wait_frames) {
+                logger::instance()->warn("The receiver of a segmented can transfer kept waiting");
+                m_state = transfer_state::failed;
+            }
+            break;
+        case isotp_flow_status::overflow:
+            logger::instance()->warn("The payload of a segmented can transfer is too large for the receiver");
+            m_state = transfer_state::failed;
+            break;
+        default:
+            m_state = transfer_state::failed;
+            break;
+    }
+}
+
+std::vector<can_message> isotp_transfer::next_frames() {
+    std::vector<can_message> frames;
+
+    while (m_state == transfer_state::sending) {
+        frames.emplace_back(consecutive_frame());
+
+        if (m_sent_bytes == m_payload.size()) {
+            m_state = transfer_state::finished;
+        } else if (m_block_size != 0 && --m_frames_left_in_block == 0) {
+            m_state = transfer_state::waiting_for_flow_control;
+        } else if (m_separation_time.count() != 0) {
+            break;
+        }
+    }
+
+    return frames;
+}
+
+void isotp_transfer::abort() {
+    if (m_state != transfer_state::finished) {
+        m_state = transfer_state::failed;
+    }
+}
+
+auto isotp_transfer::state() const -> transfer_state { return m_state; }
+
+std::chrono::microseconds isotp_transfer::separation_time() const { return m_separation_time; }
+
+can_message isotp_transfer::consecutive_frame() {
+    can_message message{m_identifier};
+    size_t bytes_in_frame = std::min(m_payload.size() - m_sent_bytes, _frame_size - 1);
+
+    message.m_data[0] = isotp_frame_types::consecutive_frame | m_sequence_number;
+    std::copy_n(m_payload.cbegin() + m_sent_bytes, bytes_in_frame, message.m_data.begin() + 1);
+    message.m_length = static_cast<uint8_t>(bytes_in_frame + 1);
+
+    m_sent_bytes += bytes_in_frame;
+    m_sequence_number = (m_sequence_number + 1) & 0x0F;
+    return message;
+}
+
+std::chrono::microseconds isotp_transfer::parse_separation_time(uint8_t separation_time) {
+    if (separation_time <= 0x7F) {
+        return std::chrono::milliseconds(separation_time);
+    }
+
+    if (separation_time >= 0xF1 && separation_time <= 0xF9) {
+        return std::chrono::microseconds((separation_time - 0xF0) * 100);
+    }
+
+    // Reserved values have to be treated as the longest separation time
+    return std::chrono::milliseconds(0x7F);
+}
@@ -1,5 +1,6 @@
 #include "io/interfaces/gpio/gpio_chip.h"
 
+#include <algorithm>
 #include <charconv>
 #include <filesystem>
 #include <memory>
@@ -119,7 +120,9 @@ gpio_chip::gpio_chip(const std::filesystem::path &gpio_dev, gpiod::gpiod_chip ch
 gpio_chip::gpio_chip(gpio_chip &&other)
     : m_gpiochip_path(std::move(other.m_gpiochip_path)),
       m_chip(std::move(other.m_chip)),
-      m_reserved_pins(std::move(other.m_reserved_pins)) {
+      m_reserved_pins(std::move(other.m_reserved_pins)),
+      m_output_line_entries(std::move(other.m_output_line_entries)),
+      m_output_requests(std::move(other.m_output_requests)) {
     other.m_gpiochip_path = "";
 }
 
@@ -128,10 +131,252 @@ gpio_chip::~gpio_chip() {
         // Possible problem in libgpiod where the chip might include the pins as resources, so the pins have to be
         // destroyed before the chip
         m_reserved_pins.clear();
+        m_output_requests.clear();
+        m_output_line_entries.clear();
         m_chip.release_resource();
     }
 }
 
+std::optional<size_t> gpio_chip::request_output_line(unsigned int offset, int flags) {
+    std::lock_guard<std::mutex> output_guard{m_output_mutex};
+
+    auto entry = std::find_if(m_output_line_entries.begin(), m_output_line_entries.end(),
+                              [offset](const auto &current_entry) { return current_entry.m_offset == offset; });
+
+    if (entry != m_output_line_entries.end() && entry->m_is_used) {
+        logger::instance()->critical("The output line {} of gpiochip {} is already requested", offset,
+                                     m_gpiochip_path.c_str());
+        return {};
+    }
+
+    size_t index = std::distance(m_output_line_entries.begin(), entry);
+
+    if (entry == m_output_line_entries.end()) {
+        auto line = m_chip.get_line(offset);
+
+        if (!line) {
+            logger::instance()->critical("Couldn't get the output line {} of gpiochip {}", offset,
+                                         m_gpiochip_path.c_str());
+            return {};
+        }
+
+        m_output_line_entries.emplace_back(output_line{offset, std::move(line), 0, {}, false});
+    }
+
+    auto &requested_entry = m_output_line_entries[index];
+
+    // A released line, which is still requested with other lines, is used again as it is
+    if (!requested_entry.m_request.has_value() &&
+        !add_output_request({index}, {requested_entry.m_value}, flags).has_value()) {
+        logger::instance()->critical("Couldn't request the output line {} of gpiochip {}", offset,
+                                     m_gpiochip_path.c_str());
+        return {};
+    }
+
+    requested_entry.m_is_used = true;
+    return index;
+}
+
+void gpio_chip::release_output_line(size_t index) {
+    std::lock_guard<std::mutex> output_guard{m_output_mutex};
+
+    if (index >= m_output_line_entries.size() || !m_output_line_entries[index].m_is_used) {
+        return;
+    }
+
+    auto &released_entry = m_output_line_entries[index];
+    released_entry.m_is_used = false;
+
+    if (!released_entry.m_request.has_value()) {
+        return;
+    }
+
+    // The other lines of the request keep their request, so they aren't disturbed
+    const auto &request_indices = m_output_requests[*released_entry.m_request]->m_indices;
+    bool is_request_used = std::any_of(request_indices.cbegin(), request_indices.cend(), [this](auto line_index) {
+        return m_output_line_entries[line_index].m_is_used;
+    });
+
+    if (!is_request_used) {
+        remove_output_request(*released_entry.m_request);
+    }
+}
+
+std::optional<size_t> gpio_chip::add_output_request(const std::vector<size_t> &indices,
+                                                    const std::vector<int> &values, int flags) {
+    gpiod::gpiod_line_bulk bulk;
+
+    for (auto current_index : indices) {
+        if (!bulk.add(m_output_line_entries[current_index].m_line)) {
+            return {};
+        }
+    }
+
+    if (bulk.request_output_flags("quarium_controller", flags, values.data()) == -1) {
+        return {};
+    }
+
+    auto empty_request = std::find_if(m_output_requests.begin(), m_output_requests.end(),
+                                      [](const auto &current_request) { return !current_request.has_value(); });
+    size_t request_index = std::distance(m_output_requests.begin(), empty_request);
+
+    if (empty_request == m_output_requests.end()) {
+        m_output_requests.emplace_back();
+    }
+
+    m_output_requests[request_index] = output_request{std::move(bulk), indices, flags};
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        m_output_line_entries[indices[i]].m_request = request_index;
+        m_output_line_entries[indices[i]].m_value = values[i];
+    }
+
+    return request_index;
+}
+
+void gpio_chip::remove_output_request(size_t request_index) {
+    auto &removed_request = m_output_requests[request_index];
+
+    for (auto current_index : removed_request->m_indices) {
+        m_output_line_entries[current_index].m_request.reset();
+    }
+
+    removed_request->m_bulk.release_resource();
+    removed_request.reset();
+}
+
+// The requests are only merged, if all the used lines of them are written anyway, so no other line is disturbed. If the
+// merged request fails, the lines are requested like before
+bool gpio_chip::merge_output_requests(const std::vector<size_t> &request_indices,
+                                      const std::map<size_t, int> &values) {
+    std::vector<std::vector<size_t>> previous_indices;
+    std::vector<size_t> merged_indices;
+    std::vector<int> merged_values;
+    int flags = m_output_requests[request_indices.front()]->m_flags;
+
+    for (auto current_request : request_indices) {
+        previous_indices.emplace_back();
+
+        for (auto current_index : m_output_requests[current_request]->m_indices) {
+            // Released lines aren't taken into the merged request
+            if (m_output_line_entries[current_index].m_is_used) {
+                previous_indices.back().emplace_back(current_index);
+                merged_indices.emplace_back(current_index);
+                merged_values.emplace_back(values.at(current_index));
+            }
+        }
+
+        remove_output_request(current_request);
+    }
+
+    if (add_output_request(merged_indices, merged_values, flags).has_value()) {
+        return true;
+    }
+
+    logger::instance()->warn("Couldn't request {} output lines of gpiochip {} together", merged_indices.size(),
+                             m_gpiochip_path.c_str());
+
+    bool is_written = true;
+
+    for (const auto &current_indices : previous_indices) {
+        std::vector<int> current_values;
+
+        for (auto current_index : current_indices) {
+            current_values.emplace_back(values.at(current_index));
+        }
+
+        if (!add_output_request(current_indices, current_values, flags).has_value()) {
+            logger::instance()->critical("Couldn't request the output lines of gpiochip {} again",
+                                         m_gpiochip_path.c_str());
+            is_written = false;
+        }
+    }
+
+    return is_written;
+}
+
+bool gpio_chip::write_output_request(size_t request_index, const std::map<size_t, int> &values) {
+    auto &written_request = *m_output_requests[request_index];
+    std::vector<int> request_values;
+    request_values.reserve(written_request.m_indices.size());
+
+    for (auto current_index : written_request.m_indices) {
+        auto new_value = values.find(current_index);
+        request_values.push_back(new_value != values.cend() ? new_value->second
+                                                             : m_output_line_entries[current_index].m_value);
+    }
+
+    if (!written_request.m_bulk || written_request.m_bulk.set_values(request_values.data()) == -1) {
+        return false;
+    }
+
+    for (size_t i = 0; i < written_request.m_indices.size(); ++i) {
+        m_output_line_entries[written_request.m_indices[i]].m_value = request_values[i];
+    }
+
+    return true;
+}
+
+bool gpio_chip::set_output_values(const std::vector<std::pair<size_t, int>> &values) {
+    std::lock_guard<std::mutex> output_guard{m_output_mutex};
+
+    std::map<size_t, std::map<size_t, int>> values_per_request;
+
+    for (const auto &[index, value] : values) {
+        if (index >= m_output_line_entries.size() || !m_output_line_entries[index].m_is_used ||
+            !m_output_line_entries[index].m_request.has_value()) {
+            return false;
+        }
+
+        values_per_request[*m_output_line_entries[index].m_request][index] = value;
+    }
+
+    // Requests, of which every used line is written, can be merged without disturbing any other line
+    std::vector<size_t> mergeable_requests;
+    std::map<size_t, int> mergeable_values;
+    size_t number_of_merged_lines = 0;
+
+    for (const auto &[request_index, request_values] : values_per_request) {
+        const auto &request_indices = m_output_requests[request_index]->m_indices;
+        auto used_lines = std::count_if(request_indices.cbegin(), request_indices.cend(), [this](auto line_index) {
+            return m_output_line_entries[line_index].m_is_used;
+        });
+
+        if (static_cast<size_t>(used_lines) == request_values.size()) {
+            mergeable_requests.emplace_back(request_index);
+            mergeable_values.insert(request_values.cbegin(), request_values.cend());
+            number_of_merged_lines += request_values.size();
+        }
+    }
+
+    bool is_written = true;
+
+    if (mergeable_requests.size() > 1 && number_of_merged_lines <= static_cast<size_t>(GPIOD_LINE_BULK_MAX_LINES)) {
+        // The lines get their new values with the request
+        is_written = merge_output_requests(mergeable_requests, mergeable_values);
+
+        for (auto current_request : mergeable_requests) {
+            values_per_request.erase(current_request);
+        }
+    }
+
+    for (const auto &[request_index, request_values] : values_per_request) {
+        is_written = write_output_request(request_index, request_values) && is_written;
+    }
+
+    return is_written;
+}
+
+std::optional<int> gpio_chip::output_line_value(size_t index) const {
+    std::lock_guard<std::mutex> output_guard{m_output_mutex};
+
+    if (index >= m_output_line_entries.size() || !m_output_line_entries[index].m_is_used) {
+        return {};
+    }
+
+    return m_output_line_entries[index].m_value;
+}
+
 const std::filesystem::path &gpio_chip::path_to_file() const { return m_gpiochip_path; }
 
 std::shared_ptr<gpio_pin> gpio_chip::open_pin(const gpio_pin_id &id) {
@@ -0,0 +1,157 @@
+#include "io/interfaces/gpio/gpio_input.h"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "io/interfaces/gpio/gpio_chip.h"
+#include "io/interfaces/io_event_loop.h"
+#include "logger.h"
+#include "utils.h"
+
+gpio_input::gpio_input(std::shared_ptr<gpio_chip> chip_instance, unsigned int pin, gpiod::gpiod_line line,
+                       int timer_fd, std::chrono::milliseconds debounce_time)
+    : m_gpiochip_instance(std::move(chip_instance)),
+      m_pin(pin),
+      m_line(std::move(line)),
+      m_timer_fd(timer_fd),
+      m_debounce_time(debounce_time) {
+    m_value = std::max(m_line.get_value(), 0);
+    m_pending_value = m_value;
+}
+
+gpio_input::~gpio_input() {
+    if (auto event_loop_instance = io_event_loop::instance(); event_loop_instance != nullptr) {
+        event_loop_instance->unwatch(m_line.event_fd());
+        event_loop_instance->unwatch(m_timer_fd);
+    }
+
+    close(m_timer_fd);
+}
+
+std::unique_ptr<input_interface> gpio_input::create_for_interface(const nlohmann::json &description) {
+    auto logger_instance = logger::instance();
+
+    if (!description.is_object()) {
+        return nullptr;
+    }
+
+    // Optional entries are missing, so they can't be accessed with operator[] of the const description
+    nlohmann::json pin_entry = description.value("pin", nlohmann::json{});
+    nlohmann::json debounce_entry = description.value("debounce", nlohmann::json{});
+    nlohmann::json active_low_entry = description.value("active_low", nlohmann::json{});
+
+    if (pin_entry.is_null() || !pin_entry.is_number_unsigned()) {
+        logger_instance->critical("The pin of a gpio input is missing or not a number");
+        return nullptr;
+    }
+
+    auto pin_number = pin_entry.get<unsigned int>();
+    auto debounce_time = _default_debounce_time;
+
+    if (debounce_entry.is_string()) {
+        auto parsed_debounce_time = parse_duration<std::chrono::milliseconds>(debounce_entry.get<std::string>());
+
+        if (!parsed_debounce_time.has_value()) {
+            logger_instance->critical("The debounce time of the gpio input {} is invalid", pin_number);
+            return nullptr;
+        }
+
+        debounce_time = *parsed_debounce_time;
+    }
+
+    bool is_active_low = active_low_entry.is_boolean() && active_low_entry.get<bool>();
+
+    // TODO: make path configurable
+    auto gpio_chip_instance = gpio_chip::instance();
+    auto event_loop_instance = io_event_loop::instance();
+
+    if (!gpio_chip_instance || !event_loop_instance) {
+        return nullptr;
+    }
+
+    gpiod::gpiod_line line = gpio_chip_instance->m_chip.get_line(pin_number);
+
+    if (!line || line.request_both_edges_events_flags("quarium_controller",
+                                                      is_active_low ? GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW : 0) == -1) {
+        logger_instance->critical("Couldn't request the events of the gpio input {}", pin_number);
+        return nullptr;
+    }
+
+    // All the events of a line are read at once, until no event is left
+    int event_fd = line.event_fd();
+    fcntl(event_fd, F_SETFL, fcntl(event_fd, F_GETFL) | O_NONBLOCK);
+
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (timer_fd == -1) {
+        logger_instance->critical("Couldn't create the debounce timer of the gpio input {}", pin_number);
+        return nullptr;
+    }
+
+    // The input is created with new, because the constructor is private
+    auto created_input = std::unique_ptr<gpio_input>(
+        new gpio_input(std::move(gpio_chip_instance), pin_number, std::move(line), timer_fd, debounce_time));
+    auto input = created_input.get();
+
+    bool is_watched =
+        event_loop_instance->watch(event_fd, EPOLLIN, [input](uint32_t) { input->read_line_events(); }) &&
+        event_loop_instance->watch(timer_fd, EPOLLIN, [input](uint32_t) { input->debounce_time_passed(); });
+
+    if (!is_watched) {
+        logger_instance->critical("Couldn't watch the events of the gpio input {}", pin_number);
+        return nullptr;
+    }
+
+    return created_input;
+}
+
+std::optional<output_value> gpio_input::read_value() const {
+    return output_value(m_value.load() ? switch_output::on : switch_output::off);
+}
+
+void gpio_input::read_line_events() {
+    gpiod::native_gpiod_line_event event;
+    bool has_new_edge = false;
+
+    while (m_line.read_event(&event) == 0) {
+        m_pending_value = event.event_type == GPIOD_LINE_EVENT_RISING_EDGE ? 1 : 0;
+        m_pending_timestamp = std::chrono::seconds(event.ts.tv_sec) + std::chrono::nanoseconds(event.ts.tv_nsec);
+        has_new_edge = true;
+    }
+
+    if (!has_new_edge) {
+        return;
+    }
+
+    if (m_debounce_time.count() == 0) {
+        accept_pending_value();
+        return;
+    }
+
+    // Every edge restarts the debounce time, so the value is only accepted after the line settled
+    itimerspec debounce_timer{};
+    debounce_timer.it_value.tv_sec = m_debounce_time.count() / 1000;
+    debounce_timer.it_value.tv_nsec = (m_debounce_time.count() % 1000) * 1000000;
+    timerfd_settime(m_timer_fd, 0, &debounce_timer, nullptr);
+}
+
+void gpio_input::debounce_time_passed() {
+    uint64_t expirations = 0;
+
+    if (read(m_timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+
+    accept_pending_value();
+}
+
+void gpio_input::accept_pending_value() {
+    if (m_pending_value == m_value.load()) {
+        return;
+    }
+
+    m_value = m_pending_value;
+    notify(input_event{output_value(m_pending_value ? switch_output::on : switch_output::off), m_pending_timestamp});
+}
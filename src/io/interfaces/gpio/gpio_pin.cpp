@@ -35,15 +35,25 @@ output_value gpio_pin::current_state() const {
     return controlled_state;
 }
 
-gpio_pin::gpio_pin(std::weak_ptr<gpio_chip> chip_instance, gpio_pin_id id, gpiod::gpiod_line line)
-    : m_id(id), m_line(std::move(line)), m_gpiochip_instance(chip_instance) {}
+gpio_pin::gpio_pin(std::weak_ptr<gpio_chip> chip_instance, gpio_pin_id id, size_t line_index)
+    : m_id(id), m_line_index(line_index), m_gpiochip_instance(chip_instance) {}
 
 gpio_pin::gpio_pin(gpio_pin &&other)
     : m_id(std::move(other.m_id)),
-      m_line(std::move(other.m_line)),
+      m_line_index(other.m_line_index),
       m_controlled_value(std::move(other.m_controlled_value)),
       m_overriden_value(std::move(other.m_overriden_value)),
-      m_gpiochip_instance(other.m_gpiochip_instance) {}
+      m_gpiochip_instance(other.m_gpiochip_instance) {
+    other.m_line_index.reset();
+}
+
+gpio_pin::~gpio_pin() {
+    auto chip_instance = m_gpiochip_instance.lock();
+
+    if (m_line_index.has_value() && chip_instance) {
+        chip_instance->release_output_line(*m_line_index);
+    }
+}
 
 std::optional<gpio_pin> gpio_pin::open(std::shared_ptr<gpio_chip> chip_instance, gpio_pin_id id) {
     auto logger_instance = logger::instance();
@@ -52,28 +62,21 @@ std::optional<gpio_pin> gpio_pin::open(std::shared_ptr<gpio_chip> chip_instance,
         return std::nullopt;
     }
 
-    gpiod::gpiod_line line = chip_instance->m_chip.get_line(id.id());
-
-    if (!line) {
-        logger_instance->critical("Couldn't get line with id {}", id.id());
-        return std::nullopt;
-    }
-
     auto invert_signal_entry = config::instance()->find("invert_output");
     auto invert_signal = false;
 
     if (!invert_signal_entry.is_null() && invert_signal_entry.is_boolean()) {
         invert_signal = invert_signal_entry.get<bool>();
     }
-    int result =
-        line.request_output_flags("quarium_controller", invert_signal ? GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW : 0, 0);
+    auto line_index =
+        chip_instance->request_output_line(id.id(), invert_signal ? GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW : 0);
 
-    if (result == -1) {
+    if (!line_index.has_value()) {
         logger_instance->critical("Couldn't request line with id {}", id.id());
         return std::nullopt;
     }
 
-    return gpio_pin(chip_instance, std::move(id), std::move(line));
+    return gpio_pin(chip_instance, std::move(id), *line_index);
 }
 
 bool gpio_pin::control_output(const output_value &value) {
@@ -85,7 +88,7 @@ bool gpio_pin::control_output(const output_value &value) {
     m_controlled_value = *contained_value;
 
     auto chip_instance = m_gpiochip_instance.lock();
-    if (!m_line || !chip_instance) {
+    if (!m_line_index.has_value() || !chip_instance) {
         return false;
     }
 
@@ -124,36 +127,102 @@ bool gpio_pin::restore_control() {
 }
 
 bool gpio_pin::update_gpio() {
-    switch_output to_write = m_controlled_value;
+    auto chip_instance = m_gpiochip_instance.lock();
+
+    if (!m_line_index.has_value() || !chip_instance) {
+        return false;
+    }
 
     if (m_overriden_value.has_value()) {
         logger::instance()->info("Action is overriden");
-        to_write = *m_overriden_value;
     }
 
-    int value = m_line.get_value();
+    auto current_line_value = chip_instance->output_line_value(*m_line_index);
+
+    if (!current_line_value.has_value()) {
+        return false;
+    }
+
+    auto value_to_write = line_value_to_write(*current_line_value);
 
-    if (value == -1) {
+    if (!value_to_write.has_value()) {
         return false;
     }
 
-    if ((switch_output)value == to_write) {
+    if (*value_to_write == *current_line_value) {
         return true;
     }
 
-    switch (to_write) {
+    return chip_instance->set_output_values({{*m_line_index, *value_to_write}});
+}
+
+std::optional<int> gpio_pin::line_value_to_write(int current_line_value) const {
+    switch (m_overriden_value.value_or(m_controlled_value)) {
         case switch_output::on:
-            return m_line.set_value(1) == 0 ? true : false;
+            return 1;
         case switch_output::off:
-            return m_line.set_value(0) == 0 ? true : false;
+            return 0;
         case switch_output::toggle:
-            return m_line.set_value(!value) == 0 ? true : false;
+            return !current_line_value;
         default:
             logger::instance()->critical("Invalid switch_output to write to gpio {}", gpio_id());
             break;
     }
 
-    return false;
+    return {};
+}
+
+const void *gpio_pin::batch_driver() const { return m_gpiochip_instance.lock().get(); }
+
+// All the pins of the batch belong to the chip of this pin, their lines are set with one call
+std::vector<bool> gpio_pin::control_outputs(const output_batch &batch) {
+    std::vector<bool> results(batch.size(), false);
+    auto chip_instance = m_gpiochip_instance.lock();
+
+    if (!chip_instance) {
+        return results;
+    }
+
+    // Later controls of a pin replace the earlier ones, like they would if the pins were controlled one by one
+    std::map<size_t, int> line_values;
+    std::vector<size_t> controlled_pins;
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto &pin = static_cast<gpio_pin &>(*batch[i].first);
+        auto contained_value = batch[i].second.get<switch_output>();
+
+        if (!contained_value.has_value() || !pin.m_line_index.has_value()) {
+            continue;
+        }
+
+        pin.m_controlled_value = *contained_value;
+
+        auto line_index = *pin.m_line_index;
+        auto current_line_value = line_values.find(line_index) != line_values.cend()
+                                      ? std::optional<int>(line_values[line_index])
+                                      : chip_instance->output_line_value(line_index);
+
+        if (!current_line_value.has_value()) {
+            continue;
+        }
+
+        if (auto value_to_write = pin.line_value_to_write(*current_line_value); value_to_write.has_value()) {
+            line_values[line_index] = *value_to_write;
+            controlled_pins.emplace_back(i);
+        }
+    }
+
+    logger::instance()->info("Switching {} gpios of chip {} at once", line_values.size(),
+                             chip_instance->path_to_file().c_str());
+
+    bool is_written =
+        chip_instance->set_output_values(std::vector<std::pair<size_t, int>>(line_values.cbegin(), line_values.cend()));
+
+    for (auto current_index : controlled_pins) {
+        results[current_index] = is_written;
+    }
+
+    return results;
 }
 
 unsigned int gpio_pin::gpio_id() const { return m_id.id(); }
@@ -0,0 +1,133 @@
+#include "io/interfaces/io_event_loop.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+
+#include "logger.h"
+
+std::shared_ptr<io_event_loop> io_event_loop::instance() { return singleton<io_event_loop>::instance(); }
+
+io_event_loop::io_event_loop()
+    : m_epoll_fd(epoll_create1(EPOLL_CLOEXEC)), m_wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (m_epoll_fd == -1 || m_wake_fd == -1) {
+        logger::instance()->critical("Couldn't create the file descriptors of the io event loop");
+        return;
+    }
+
+    epoll_event wake_event{};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = m_wake_fd;
+
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &wake_event) == -1) {
+        logger::instance()->critical("Couldn't watch the wake up event of the io event loop");
+        return;
+    }
+
+    m_loop_thread = std::thread(&io_event_loop::process_events, this);
+}
+
+io_event_loop::~io_event_loop() {
+    if (m_loop_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> callbacks_guard{m_callbacks_mutex};
+            m_exit_thread = true;
+        }
+
+        uint64_t wake_up = 1;
+        write(m_wake_fd, &wake_up, sizeof(wake_up));
+        m_loop_thread.join();
+    }
+
+    if (m_wake_fd != -1) {
+        close(m_wake_fd);
+    }
+
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+    }
+}
+
+bool io_event_loop::watch(int fd, uint32_t events, event_callback callback) {
+    if (!m_loop_thread.joinable()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> callbacks_guard{m_callbacks_mutex};
+
+    epoll_event watched_event{};
+    watched_event.events = events;
+    watched_event.data.fd = fd;
+
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &watched_event) == -1) {
+        logger::instance()->critical("Couldn't watch the file descriptor {} : {}", fd, errno);
+        return false;
+    }
+
+    m_callbacks[fd] = std::make_shared<event_callback>(std::move(callback));
+    return true;
+}
+
+bool io_event_loop::modify(int fd, uint32_t events) {
+    epoll_event watched_event{};
+    watched_event.events = events;
+    watched_event.data.fd = fd;
+
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &watched_event) == 0;
+}
+
+void io_event_loop::unwatch(int fd) {
+    std::unique_lock<std::mutex> callbacks_guard{m_callbacks_mutex};
+
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    m_callbacks.erase(fd);
+
+    if (std::this_thread::get_id() == m_loop_thread.get_id()) {
+        return;
+    }
+
+    m_callback_finished.wait(callbacks_guard, [this, fd]() { return m_running_fd != fd; });
+}
+
+void io_event_loop::process_events() {
+    std::array<epoll_event, _max_events_per_wait> events;
+
+    while (true) {
+        int number_of_events = epoll_wait(m_epoll_fd, events.data(), events.size(), -1);
+
+        if (number_of_events == -1 && errno != EINTR) {
+            logger::instance()->critical("Waiting for io events failed : {}", errno);
+            return;
+        }
+
+        std::unique_lock<std::mutex> callbacks_guard{m_callbacks_mutex};
+
+        if (m_exit_thread) {
+            return;
+        }
+
+        for (int i = 0; i < number_of_events; ++i) {
+            // epoll_event is packed, so the members are copied instead of referenced
+            int fd = events[i].data.fd;
+            uint32_t occured_events = events[i].events;
+            auto callback = m_callbacks.find(fd);
+
+            // The file descriptor could have been unwatched by an earlier callback
+            if (callback == m_callbacks.cend()) {
+                continue;
+            }
+
+            auto current_callback = callback->second;
+            m_running_fd = fd;
+
+            callbacks_guard.unlock();
+            (*current_callback)(occured_events);
+            callbacks_guard.lock();
+
+            m_running_fd.reset();
+            m_callback_finished.notify_all();
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #include "io/outputs/can/can_output.h"
 
-#include "io/outputs/output_transition.h"
+#include <algorithm>
+#include <cstring>
+
 #include "logger.h"
 #include "utils.h"
 
@@ -37,8 +39,53 @@ std::unique_ptr<can_output> can_output::create_for_interface(const nlohmann::jso
         return nullptr;
     }
 
+    std::shared_ptr<can_transport> transport = nullptr;
+    auto flow_control_entry = description.value("flow_control_identifier", nlohmann::json{});
+
+    if (!flow_control_entry.is_null()) {
+        if (!flow_control_entry.is_number_unsigned()) {
+            logger::instance()->critical("The flow control identifier of the can output {} is invalid",
+                                         object_identifier);
+            return nullptr;
+        }
+
+        transport = can_transport::create(can_device_instance, can_object_identifier(object_identifier),
+                                          can_object_identifier(flow_control_entry.get<unsigned int>()));
+
+        if (!transport) {
+            return nullptr;
+        }
+    }
+
     // TODO: if there is an error parsing this, return a nullptr, also add the period parameter, also create seperate
     // type
+    if (!transition_entry.is_null() && transition_entry.is_object() && transition_entry["duration"].is_string()) {
+        auto duration = parse_duration<std::chrono::milliseconds>(transition_entry["duration"].get<std::string>());
+        auto curve = output_transitions::transition_curve::linear;
+
+        if (!duration) {
+            logger::instance()->critical("The duration of the transition of the can output {} is invalid",
+                                         object_identifier);
+            return nullptr;
+        }
+
+        if (transition_entry["type"].is_string()) {
+            auto parsed_curve = output_transitions::curve_from_string(transition_entry["type"].get<std::string>());
+
+            if (!parsed_curve) {
+                logger::instance()->critical("The type of the transition of the can output {} is unknown",
+                                             object_identifier);
+                return nullptr;
+            }
+
+            curve = *parsed_curve;
+        }
+
+        return std::unique_ptr<can_output>(
+            new can_output(can_device_instance, transport, can_object_identifier(object_identifier), default_value,
+                           output_transitions::timed_transition<>(curve, *duration)));
+    }
+
     if (!transition_entry.is_null() && transition_entry.is_object()) {
         uint32_t velocity = 1;
         std::chrono::milliseconds period_length(500);
@@ -64,44 +111,90 @@ std::unique_ptr<can_output> can_output::create_for_interface(const nlohmann::jso
         }
 
         return std::unique_ptr<can_output>(
-            new can_output(can_device_instance, can_object_identifier(object_identifier), default_value,
+            new can_output(can_device_instance, transport, can_object_identifier(object_identifier), default_value,
                            output_transitions::linear_transition<>(velocity, period_length)));
     }
 
-    return std::unique_ptr<can_output>(new can_output(can_device_instance, can_object_identifier(object_identifier),
-                                                      default_value, output_transitions::instant<>{}));
+    return std::unique_ptr<can_output>(new can_output(can_device_instance, transport,
+                                                      can_object_identifier(object_identifier), default_value,
+                                                      output_transitions::instant<>{}));
 }
 
 bool can_output::control_output(const output_value &value) {
     m_value = value;
     m_transitioner.target_value(value);
 
-    return sync_values() == can_error_code::ok;
+    return sync_values(value) == can_error_code::ok;
 }
 
 bool can_output::override_with(const output_value &value) {
     m_overriden_value = value;
     m_transitioner.target_value(value);
 
-    return sync_values() == can_error_code::ok;
+    return sync_values(value) == can_error_code::ok;
 }
 
 bool can_output::restore_control() {
     m_overriden_value.reset();
     m_transitioner.target_value(m_value);
 
-    return sync_values() == can_error_code::ok;
+    return sync_values(m_value) == can_error_code::ok;
 }
 
 std::optional<output_value> can_output::is_overriden() const { return m_overriden_value; }
 
 output_value can_output::current_state() const { return m_transitioner.current_value(); }
 
-can_error_code can_output::sync_values() { return update_value(); }
+can_error_code can_output::sync_values(const output_value &target_value) {
+    return update_value(value_to_send(target_value));
+}
+
+// The step of the transition runs later on the thread of the transition engine, so the current state would still be
+// the previous value
+output_value can_output::value_to_send(const output_value &target_value) const {
+    return m_is_instant ? target_value : current_state();
+}
+
+const void *can_output::batch_driver() const { return m_can_instance.get(); }
 
-can_error_code can_output::update_value() {
-    auto logger_instance = logger::instance();
-    output_value value = current_state();
+std::vector<bool> can_output::control_outputs(const output_batch &batch) {
+    std::vector<bool> results(batch.size(), false);
+    std::vector<can_message> messages;
+    std::vector<size_t> sent_controls;
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto &output = static_cast<can_output &>(*batch[i].first);
+
+        output.m_value = batch[i].second;
+        output.m_transitioner.target_value(batch[i].second);
+        auto value = output.value_to_send(batch[i].second);
+
+        // Segmented payloads are sent by the transport of the output
+        if (value.current_type() == output_value_types::string) {
+            results[i] = output.update_value(value) == can_error_code::ok;
+            continue;
+        }
+
+        if (auto message = output.message_of(value); message.has_value()) {
+            messages.emplace_back(*message);
+            sent_controls.emplace_back(i);
+        }
+    }
+
+    auto send_results = m_can_instance->send(messages);
+
+    for (size_t i = 0; i < sent_controls.size(); ++i) {
+        results[sent_controls[i]] = send_results[i] == can_error_code::ok;
+    }
+
+    if (std::find(results.cbegin(), results.cend(), false) != results.cend()) {
+        logger::instance()->warn("Couldn't send all the data of a batch with the canbus");
+    }
+
+    return results;
+}
+
+std::optional<can_message> can_output::message_of(const output_value &value) const {
     uint32_t data = 0;
 
     switch (value.current_type()) {
@@ -115,10 +208,61 @@ can_error_code can_output::update_value() {
             data = static_cast<uint32_t>(*value.get<switch_output>());
             break;
         default:
+            return {};
+    }
+
+    // The nodes expect the value in a payload of 8 bytes
+    uint64_t payload = data;
+    can_message message{m_object_identifier, sizeof(payload)};
+    std::memcpy(message.m_data.data(), (char *)&payload, sizeof(payload));
+
+    return message;
+}
+
+can_error_code can_output::update_value(const output_value &value, bool wait_for_delivery) {
+    auto logger_instance = logger::instance();
+
+    if (value.current_type() == output_value_types::string) {
+        auto contained_string = value.get<std::string>();
+
+        // The outputs don't know if they will get strings, so this is only reported, when the first string is sent
+        if (!m_transport) {
+            if (!m_reported_missing_transport.exchange(true)) {
+                logger_instance->critical(
+                    "The can output {} can't send strings, because it has no flow_control_identifier",
+                    (int)m_object_identifier);
+            }
+
+            return can_error_code::send_error;
+        }
+
+        if (!contained_string.has_value()) {
             return can_error_code::send_error;
+        }
+
+        auto is_delivered =
+            m_transport->send(std::vector<uint8_t>(contained_string->cbegin(), contained_string->cend()));
+
+        // The pushes of the transition don't wait, the next push would be delayed by the transfer otherwise
+        if (!wait_for_delivery) {
+            return can_error_code::ok;
+        }
+
+        if (!is_delivered.get()) {
+            logger_instance->warn("The can output {} couldn't deliver a string", (int)m_object_identifier);
+            return can_error_code::send_error;
+        }
+
+        return can_error_code::ok;
+    }
+
+    auto message = message_of(value);
+
+    if (!message.has_value()) {
+        return can_error_code::send_error;
     }
 
-    auto result = m_can_instance->send(m_object_identifier, data);
+    auto result = m_can_instance->send(*message);
 
     // TODO: request data, so that one can confirm that the data has actually been written
     if (result != can_error_code::ok) {
@@ -52,9 +52,9 @@ std::unique_ptr<mqtt_output> mqtt_output::create_for_interface(const nlohmann::j
                                                         output_value{default_value}, output_transitions::instant<>{}));
 }
 
-bool mqtt_output::sync_values() { return update_value(); }
+bool mqtt_output::sync_values() { return update_value(current_state()); }
 
-bool mqtt_output::update_value() {
+bool mqtt_output::update_value(const output_value &value) {
     auto logger_instance = logger::instance();
     if (!m_mqtt_instance) {
         logger_instance->critical("No valid mqtt_instance for this instance is available");
@@ -62,7 +62,6 @@ bool mqtt_output::update_value() {
     }
 
     std::string value_to_send = "";
-    output_value value = current_state();
 
     switch (value.current_type()) {
         case output_value_types::string:
@@ -0,0 +1,92 @@
+#include "io/outputs/output_change_bus.h"
+
+output_change_subscription::output_change_subscription(size_t capacity) : m_changes(capacity) {}
+
+output_change_subscription::~output_change_subscription() { output_change_bus::remove_expired_subscribers(); }
+
+std::optional<output_change> output_change_subscription::try_pop() { return m_changes.try_pop(); }
+
+std::optional<output_change> output_change_subscription::wait_pop(std::chrono::milliseconds timeout) {
+    if (auto change = try_pop(); change.has_value()) {
+        return change;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> wait_guard{m_wait_mutex};
+
+    // Pairs with the fence of push, either the publisher sees the waiting flag or this thread sees the change
+    m_is_waiting.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::optional<output_change> change;
+    while (!(change = try_pop()).has_value()) {
+        if (m_changes_available.wait_until(wait_guard, deadline) == std::cv_status::timeout) {
+            change = try_pop();
+            break;
+        }
+    }
+
+    m_is_waiting.store(false);
+    return change;
+}
+
+size_t output_change_subscription::dropped_changes() const { return m_dropped_changes.load(); }
+
+void output_change_subscription::push(const output_change &change) {
+    if (!m_changes.try_push(change)) {
+        m_dropped_changes.fetch_add(1);
+        return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_is_waiting.load()) {
+        std::lock_guard<std::mutex> wait_guard{m_wait_mutex};
+        m_changes_available.notify_all();
+    }
+}
+
+std::shared_ptr<output_change_subscription> output_change_bus::subscribe(size_t capacity) {
+    // The constructor is private, so make_shared can't be used
+    auto subscription = std::shared_ptr<output_change_subscription>(new output_change_subscription(capacity));
+
+    std::lock_guard<std::mutex> subscribers_guard{_subscribers_mutex};
+    auto subscribers = std::make_shared<subscriber_list>(*std::atomic_load(&_subscribers));
+    subscribers->emplace_back(subscription);
+
+    _number_of_subscribers.store(subscribers->size());
+    std::atomic_store(&_subscribers, std::shared_ptr<const subscriber_list>(std::move(subscribers)));
+
+    return subscription;
+}
+
+void output_change_bus::publish(output_handle output, const output_value &value, output_change_source source) {
+    if (!has_subscribers()) {
+        return;
+    }
+
+    auto subscribers = std::atomic_load(&_subscribers);
+    output_change change{output, value, source, std::chrono::steady_clock::now()};
+
+    for (const auto &current_subscriber : *subscribers) {
+        if (auto subscription = current_subscriber.lock(); subscription != nullptr) {
+            subscription->push(change);
+        }
+    }
+}
+
+bool output_change_bus::has_subscribers() { return _number_of_subscribers.load() > 0; }
+
+void output_change_bus::remove_expired_subscribers() {
+    std::lock_guard<std::mutex> subscribers_guard{_subscribers_mutex};
+    auto subscribers = std::make_shared<subscriber_list>();
+
+    for (const auto &current_subscriber : *std::atomic_load(&_subscribers)) {
+        if (!current_subscriber.expired()) {
+            subscribers->emplace_back(current_subscriber);
+        }
+    }
+
+    _number_of_subscribers.store(subscribers->size());
+    std::atomic_store(&_subscribers, std::shared_ptr<const subscriber_list>(std::move(subscribers)));
+}
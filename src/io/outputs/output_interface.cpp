@@ -1,6 +1,27 @@
 #include "io/outputs/output_interface.h"
 #include "logger.h"
 
+const void *output_interface::batch_driver() const { return nullptr; }
+
+std::vector<bool> output_interface::control_outputs(const output_batch &batch) {
+    std::vector<bool> results;
+    results.reserve(batch.size());
+
+    for (const auto &[output, value] : batch) {
+        results.push_back(output->control_output(value));
+    }
+
+    return results;
+}
+
+void output_interface::on_value_changed(change_callback callback) { m_on_value_changed = std::move(callback); }
+
+void output_interface::value_changed(const output_value &value) const {
+    if (m_on_value_changed) {
+        m_on_value_changed(value);
+    }
+}
+
 std::shared_ptr<output_factory> output_factory::instance() { return singleton<output_factory>::instance(); }
 
 std::unique_ptr<output_interface> output_factory::deserialize(const std::string &type, const json &description) {
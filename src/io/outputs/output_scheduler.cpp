@@ -1,19 +1,51 @@
 #include "io/outputs/output_scheduler.h"
 
 #include <algorithm>
+#include <numeric>
 #include <type_traits>
 
+#include "config.h"
 #include "logger.h"
 
+batch_output_control::batch_output_control(const std::vector<std::pair<output_id, output_value>> &output_control) {
+    add_output_controls(output_control);
+}
+
 batch_output_control &batch_output_control::add_output_control(std::pair<output_id, output_value> output_control) {
+    auto handle = outputs::find_handle(output_control.first);
+
+    if (!handle.has_value()) {
+        logger::instance()->warn("There is no output with the id {}", output_control.first);
+        m_failures.emplace_back(std::move(output_control.first));
+    }
+
+    m_output_controls.emplace_back(handle.value_or(unknown_output), std::move(output_control.second));
+    m_origins.emplace_back(no_origin);
+    return *this;
+}
+
+batch_output_control &batch_output_control::add_output_control(output_control_type output_control) {
     m_output_controls.emplace_back(std::move(output_control));
+    m_origins.emplace_back(no_origin);
     return *this;
 }
 
 batch_output_control &batch_output_control::add_output_controls(
     const std::vector<std::pair<output_id, output_value>> &output_control) {
     m_output_controls.reserve(m_output_controls.size() + output_control.size() + 1);
+
+    for (const auto &current_output_control : output_control) {
+        add_output_control(current_output_control);
+    }
+
+    return *this;
+}
+
+batch_output_control &batch_output_control::add_output_controls(const std::vector<output_control_type> &output_control,
+                                                                size_t origin) {
+    m_output_controls.reserve(m_output_controls.size() + output_control.size() + 1);
     std::copy(output_control.cbegin(), output_control.cend(), std::back_inserter(m_output_controls));
+    m_origins.resize(m_output_controls.size(), origin);
     return *this;
 }
 
@@ -22,60 +54,573 @@ batch_output_control &batch_output_control::optimize_outputs(bool value) {
     return *this;
 }
 
+batch_output_control &batch_output_control::timeout(std::chrono::milliseconds batch_timeout) {
+    m_timeout = batch_timeout;
+    return *this;
+}
+
+batch_output_control &batch_output_control::output_timeout(std::chrono::milliseconds single_output_timeout) {
+    m_output_timeout = single_output_timeout;
+    return *this;
+}
+
 size_t batch_output_control::number_of_occured_errors() const { return m_failures.size(); }
 
 bool batch_output_control::optimize_outputs() const { return m_optimize_outputs; }
 
+std::chrono::milliseconds batch_output_control::timeout() const { return m_timeout; }
+
+std::chrono::milliseconds batch_output_control::output_timeout() const { return m_output_timeout; }
+
 std::vector<output_id> batch_output_control::occured_errors() const { return m_failures; }
 
-std::vector<std::pair<output_id, output_value>> batch_output_control::output_controls() const {
+auto batch_output_control::output_controls() const -> const std::vector<output_control_type> & {
     return m_output_controls;
 }
 
+const std::vector<size_t> &batch_output_control::origins() const { return m_origins; }
+
+// Single pass over the reported results, the returned origins are sorted
+std::vector<size_t> batch_output_control_result::failed_origins(size_t number_of_origins) const {
+    std::vector<bool> has_failed(number_of_origins, false);
+    std::vector<size_t> failed;
+
+    for (const auto &current_report : control_results) {
+        bool is_failed = current_report.result == output_control_result::failure ||
+                         current_report.result == output_control_result::timed_out;
+
+        if (!is_failed || current_report.origin >= number_of_origins) {
+            continue;
+        }
+
+        has_failed[current_report.origin] = true;
+    }
+
+    for (size_t i = 0; i < number_of_origins; ++i) {
+        if (has_failed[i]) {
+            failed.emplace_back(i);
+        }
+    }
+
+    return failed;
+}
+
+output_scheduler::output_scheduler() : m_watchdog_thread(&output_scheduler::watchdog, this) {}
+
+output_scheduler::~output_scheduler() {
+    // The workers finish their queued tasks first, they still register deadlines with the watchdog. The queues are
+    // destroyed outside of the lock, so callbacks of finished batches can still dispatch batches
+    decltype(m_queues) stopped_queues;
+    {
+        std::lock_guard<std::mutex> queues_guard{m_queues_mutex};
+        stopped_queues.swap(m_queues);
+    }
+    stopped_queues.clear();
+
+    {
+        std::lock_guard<std::mutex> deadlines_guard{m_deadlines_mutex};
+        m_stop_watchdog = true;
+    }
+
+    m_deadlines_changed.notify_one();
+    m_watchdog_thread.join();
+}
+
+std::shared_ptr<output_scheduler> output_scheduler::instance() { return singleton<output_scheduler>::instance(); }
+
 std::future<batch_output_control_result> output_scheduler::execute_batch_output_control(
     const batch_output_control &job) {
-    batch_output_control job_copy(job);
-    return std::async(std::launch::async, do_output_job, std::move(job_copy));
+    auto result_promise = std::make_shared<std::promise<batch_output_control_result>>();
+    auto future = result_promise->get_future();
+
+    execute_batch_output_control(job, [result_promise](batch_output_control_result result) {
+        result_promise->set_value(std::move(result));
+    });
+
+    return future;
 }
 
-batch_output_control_result output_scheduler::do_output_job(batch_output_control job) {
-    auto logger_instance = logger::instance();
-    bool job_result = true;
+void output_scheduler::execute_batch_output_control(const batch_output_control &job, result_callback on_finished) {
+    auto batch = std::make_shared<batch_state>();
+    batch->m_job = job;
+    batch->m_on_finished = std::move(on_finished);
 
-    std::vector<std::pair<output_id, output_value>> output_controls = job.output_controls();
-    std::vector<std::pair<std::pair<output_id, output_value>, output_control_result>> control_results;
+    dispatch_batch(std::move(batch));
+}
 
-    control_results.reserve(output_controls.size());
+void output_scheduler::dispatch_batch(std::shared_ptr<batch_state> batch) {
+    auto scheduler_instance = instance();
 
-    if (job.optimize_outputs()) {
-        std::vector<std::pair<output_id, output_value>> optimized_outputs;
+    if (scheduler_instance == nullptr) {
+        logger::instance()->critical("Couldn't retrieve the output_scheduler instance");
+        finish_batch(*batch, collect_result(*batch));
+        return;
+    }
 
-        // Remove all duplicates from the job, the last value is set and overrides all other values
-        std::copy_if(output_controls.crbegin(), output_controls.crend(), std::back_inserter(optimized_outputs),
-                     [&optimized_outputs, &control_results](const auto &element_to_copy) -> bool {
-                         bool is_already_set = std::any_of(optimized_outputs.cbegin(), optimized_outputs.cend(),
-                                                           [&element_to_copy](const auto &current_element) {
-                                                               return current_element.first == element_to_copy.first;
-                                                           });
-                         if (is_already_set) {
-                             control_results.emplace_back(element_to_copy, output_control_result::skipped);
-                         }
+    const auto &job_controls = batch->m_job.output_controls();
+    const auto &job_origins = batch->m_job.origins();
+    std::vector<size_t> controls_to_execute(job_controls.size());
+    std::iota(controls_to_execute.begin(), controls_to_execute.end(), 0);
 
-                         return !is_already_set;
-                     });
+    if (batch->m_job.optimize_outputs()) {
+        controls_to_execute = coalesce_controls(*batch);
+    }
 
-        output_controls = std::move(optimized_outputs);
+    // Split the batch into one task per output, the order of the controls of one output is preserved
+    std::map<output_handle, std::vector<size_t>> controls_per_output;
+
+    for (auto current_index : controls_to_execute) {
+        controls_per_output[job_controls[current_index].first].emplace_back(current_index);
     }
 
-    for (const auto &[output_id, output_value] : output_controls) {
-        bool current_result = outputs::control_output(output_id, output_value);
+    std::vector<std::pair<std::string, output_task>> tasks;
+    tasks.reserve(controls_per_output.size());
+    batch->m_task_controls.reserve(controls_per_output.size());
+    // Outputs of the same driver share one task, so the driver can control them at once
+    std::map<const void *, size_t> task_of_driver;
+
+    for (auto &[output, controls] : controls_per_output) {
+        auto type = outputs::type_of(output);
+        auto driver = outputs::batch_driver_of(output);
+
+        if (!type.has_value() || !driver.has_value()) {
+            logger::instance()->warn("{} is not a valid handle for an output", static_cast<uint32_t>(output));
 
-        if (!current_result) {
-            logger::instance()->warn("Failed to set output {}", output_id);
-            control_results.emplace_back(std::make_pair(output_id, output_value), output_control_result::failure);
+            for (auto current_index : controls) {
+                batch->m_reports.push_back(output_control_report{
+                    job_controls[current_index], output_control_result::failure, job_origins[current_index]});
+            }
+            continue;
         }
+
+        if (auto driver_task = task_of_driver.find(*driver);
+            *driver != nullptr && driver_task != task_of_driver.cend()) {
+            auto &task_controls = batch->m_task_controls[driver_task->second];
+            tasks[driver_task->second].second.m_outputs.emplace_back(output);
+            std::copy(controls.cbegin(), controls.cend(), std::back_inserter(task_controls));
+            continue;
+        }
+
+        if (*driver != nullptr) {
+            task_of_driver.emplace(*driver, tasks.size());
+        }
+
+        tasks.emplace_back(std::move(*type), output_task{batch, batch->m_task_controls.size(), {output}, {}});
+        batch->m_task_controls.emplace_back(std::move(controls));
+    }
+
+    // The controls of a driver task are executed in the order of the job
+    for (auto &task_controls : batch->m_task_controls) {
+        std::sort(task_controls.begin(), task_controls.end());
+    }
+
+    if (tasks.empty()) {
+        finish_batch(*batch, collect_result(*batch));
+        return;
+    }
+
+    // Tasks can finish while the others are still queued, so the number of tasks has to be known beforehand
+    batch->m_remaining_tasks = tasks.size();
+    batch->m_task_done.resize(tasks.size(), false);
+    batch->m_deadline = std::chrono::steady_clock::now() + batch->m_job.timeout();
+    scheduler_instance->watch(batch->m_deadline, watched_deadline{batch, {}});
+
+    for (auto &[type, task] : tasks) {
+        task.m_queued_at = std::chrono::steady_clock::now();
+        scheduler_instance->queue_of(type).push(std::move(task));
     }
+}
+
+std::vector<output_queue_statistics> output_scheduler::queue_statistics() {
+    auto scheduler_instance = instance();
+
+    if (scheduler_instance == nullptr) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> queues_guard{scheduler_instance->m_queues_mutex};
+    std::vector<output_queue_statistics> statistics;
+    statistics.reserve(scheduler_instance->m_queues.size());
+
+    for (const auto &[type, queue] : scheduler_instance->m_queues) {
+        statistics.emplace_back(queue->statistics());
+    }
+
+    return statistics;
+}
+
+// Removes all duplicates from the job, the last value of an output is set and overrides all other values. The
+// remaining controls keep the order of the job
+std::vector<size_t> output_scheduler::coalesce_controls(batch_state &batch) {
+    const auto &job_controls = batch.m_job.output_controls();
+    const auto &job_origins = batch.m_job.origins();
+    std::vector<size_t> coalesced_controls;
+
+    // Handles are dense, so the last control of every output can be looked up by the handle. Invalid handles are
+    // never coalesced, they are reported as failures later on
+    const auto number_of_outputs = outputs::number_of_outputs();
+    std::vector<size_t> last_control_of_output(number_of_outputs, 0);
+
+    auto is_last_control = [&](size_t index) {
+        auto handle = static_cast<size_t>(job_controls[index].first);
+        return handle >= number_of_outputs || last_control_of_output[handle] == index;
+    };
+
+    for (size_t i = 0; i < job_controls.size(); ++i) {
+        if (auto handle = static_cast<size_t>(job_controls[i].first); handle < number_of_outputs) {
+            last_control_of_output[handle] = i;
+        }
+    }
+
+    coalesced_controls.reserve(job_controls.size());
+
+    for (size_t i = 0; i < job_controls.size(); ++i) {
+        if (!is_last_control(i)) {
+            batch.m_reports.push_back(
+                output_control_report{job_controls[i], output_control_result::skipped, job_origins[i]});
+            continue;
+        }
+
+        coalesced_controls.emplace_back(i);
+    }
+
+    return coalesced_controls;
+}
+
+auto output_scheduler::queue_of(const std::string &type) -> worker_queue & {
+    std::lock_guard<std::mutex> queues_guard{m_queues_mutex};
+
+    auto result = m_queues.find(type);
+
+    if (result == m_queues.cend()) {
+        result = m_queues.emplace(type, std::make_unique<worker_queue>(*this, type, configured_workers(type))).first;
+    }
+
+    return *result->second;
+}
+
+size_t output_scheduler::configured_workers(const std::string &type) {
+    auto config_instance = config::instance();
+
+    if (config_instance == nullptr) {
+        return _default_workers_per_type;
+    }
+
+    auto workers_entry = config_instance->find("output_workers");
+
+    if (workers_entry.is_null()) {
+        return _default_workers_per_type;
+    }
+
+    if (!workers_entry.is_object()) {
+        logger::instance()->warn("The output_workers entry of the config is not an object");
+        return _default_workers_per_type;
+    }
+
+    auto type_entry = workers_entry.find(type);
+
+    if (type_entry == workers_entry.cend()) {
+        return _default_workers_per_type;
+    }
+
+    if (!type_entry->is_number_unsigned() || type_entry->get<size_t>() == 0) {
+        logger::instance()->warn("The number of output workers for {} is not a positive number", type);
+        return _default_workers_per_type;
+    }
+
+    return std::min(type_entry->get<size_t>(), _max_workers_per_type);
+}
+
+void output_scheduler::watch(std::chrono::steady_clock::time_point deadline, watched_deadline watched) {
+    bool is_next_deadline = false;
 
-    return batch_output_control_result{
-        .batch_result = job_result, .output_controls = std::move(output_controls), .control_results = control_results};
+    {
+        std::lock_guard<std::mutex> deadlines_guard{m_deadlines_mutex};
+        is_next_deadline = m_deadlines.emplace(deadline, std::move(watched)) == m_deadlines.begin();
+    }
+
+    if (is_next_deadline) {
+        m_deadlines_changed.notify_one();
+    }
+}
+
+// Deadlines of tasks and batches, which are done before their deadline, are removed, so they don't pile up
+void output_scheduler::unwatch(std::chrono::steady_clock::time_point deadline,
+                               const std::shared_ptr<batch_state> &batch, std::optional<size_t> task_index) {
+    std::lock_guard<std::mutex> deadlines_guard{m_deadlines_mutex};
+    auto [deadlines_begin, deadlines_end] = m_deadlines.equal_range(deadline);
+
+    for (auto current_deadline = deadlines_begin; current_deadline != deadlines_end; ++current_deadline) {
+        const auto &watched = current_deadline->second;
+
+        // The deadline was already removed by the watchdog, if it has passed in the meantime
+        if (!watched.m_batch.owner_before(batch) && !batch.owner_before(watched.m_batch) &&
+            watched.m_task_index == task_index) {
+            m_deadlines.erase(current_deadline);
+            return;
+        }
+    }
+}
+
+// Sleeps until the next deadline, batches and tasks which are already done are ignored
+void output_scheduler::watchdog() {
+    std::unique_lock<std::mutex> deadlines_guard{m_deadlines_mutex};
+
+    while (!m_stop_watchdog) {
+        if (m_deadlines.empty()) {
+            m_deadlines_changed.wait(deadlines_guard);
+            continue;
+        }
+
+        auto next_deadline = m_deadlines.begin();
+
+        if (next_deadline->first > std::chrono::steady_clock::now()) {
+            m_deadlines_changed.wait_until(deadlines_guard, next_deadline->first);
+            continue;
+        }
+
+        auto watched = std::move(next_deadline->second);
+        m_deadlines.erase(next_deadline);
+
+        deadlines_guard.unlock();
+        if (auto batch = watched.m_batch.lock(); batch != nullptr) {
+            time_out(*batch, watched.m_task_index);
+        }
+        deadlines_guard.lock();
+    }
+}
+
+void output_scheduler::execute_task(output_task &task) {
+    auto &batch = *task.m_batch;
+    const auto &job_controls = batch.m_job.output_controls();
+    const auto &job_origins = batch.m_job.origins();
+    const auto &task_controls = batch.m_task_controls[task.m_task_index];
+    std::vector<output_control_report> failed_controls;
+    auto deadline = std::chrono::steady_clock::now() + batch.m_job.output_timeout();
+
+    watch(deadline, watched_deadline{task.m_batch, task.m_task_index});
+
+    std::vector<batch_output_control::output_control_type> controls;
+    controls.reserve(task_controls.size());
+
+    for (auto current_index : task_controls) {
+        controls.emplace_back(job_controls[current_index]);
+    }
+
+    auto results = outputs::control_outputs(controls);
+
+    for (size_t i = 0; i < task_controls.size(); ++i) {
+        if (results[i]) {
+            continue;
+        }
+
+        logger::instance()->warn("Failed to set output {}", outputs::id_of(controls[i].first).value_or("unknown"));
+        failed_controls.push_back(output_control_report{job_controls[task_controls[i]], output_control_result::failure,
+                                                        job_origins[task_controls[i]]});
+    }
+
+    unwatch(deadline, task.m_batch, task.m_task_index);
+
+    if (complete_task(batch, task.m_task_index, std::move(failed_controls))) {
+        unwatch(batch.m_deadline, task.m_batch, {});
+    }
+}
+
+// The result of a task is discarded, if the task already timed out. Returns true, if the task finished the batch
+bool output_scheduler::complete_task(batch_state &batch, size_t task_index,
+                                     std::vector<output_control_report> reports) {
+    std::unique_lock<std::mutex> state_guard{batch.m_state_mutex};
+
+    if (batch.m_is_finished || batch.m_task_done[task_index]) {
+        return false;
+    }
+
+    const auto &task_controls = batch.m_task_controls[task_index];
+    batch.m_task_done[task_index] = true;
+    std::move(reports.begin(), reports.end(), std::back_inserter(batch.m_reports));
+    std::copy(task_controls.cbegin(), task_controls.cend(), std::back_inserter(batch.m_executed_controls));
+    --batch.m_remaining_tasks;
+
+    if (batch.m_remaining_tasks != 0) {
+        return false;
+    }
+
+    auto result = collect_result(batch);
+    state_guard.unlock();
+    finish_batch(batch, std::move(result));
+    return true;
+}
+
+// Reports the controls of the task as timed out, if no task index is provided, all the tasks of the batch which are
+// not done yet time out
+void output_scheduler::time_out(batch_state &batch, std::optional<size_t> task_index) {
+    std::unique_lock<std::mutex> state_guard{batch.m_state_mutex};
+
+    if (batch.m_is_finished) {
+        return;
+    }
+
+    const auto &job_controls = batch.m_job.output_controls();
+    const auto &job_origins = batch.m_job.origins();
+    size_t tasks_begin = task_index.value_or(0);
+    size_t tasks_end = task_index.has_value() ? *task_index + 1 : batch.m_task_controls.size();
+
+    for (size_t i = tasks_begin; i < tasks_end; ++i) {
+        if (batch.m_task_done[i]) {
+            continue;
+        }
+
+        for (auto current_index : batch.m_task_controls[i]) {
+            logger::instance()->warn("Setting output {} timed out",
+                                     outputs::id_of(job_controls[current_index].first).value_or("unknown"));
+            batch.m_reports.push_back(output_control_report{
+                job_controls[current_index], output_control_result::timed_out, job_origins[current_index]});
+        }
+
+        batch.m_task_done[i] = true;
+        --batch.m_remaining_tasks;
+    }
+
+    if (batch.m_remaining_tasks != 0) {
+        return;
+    }
+
+    auto result = collect_result(batch);
+    state_guard.unlock();
+    finish_batch(batch, std::move(result));
+}
+
+// Has to be called with the state of the batch locked, if the batch is already shared with the workers
+auto output_scheduler::collect_result(batch_state &batch) -> batch_output_control_result {
+    batch.m_is_finished = true;
+
+    const auto &job_controls = batch.m_job.output_controls();
+    std::vector<batch_output_control::output_control_type> output_controls;
+    output_controls.reserve(batch.m_executed_controls.size());
+
+    // Report the executed controls in the order of the job
+    std::sort(batch.m_executed_controls.begin(), batch.m_executed_controls.end());
+
+    for (auto current_index : batch.m_executed_controls) {
+        output_controls.emplace_back(job_controls[current_index]);
+    }
+
+    return batch_output_control_result{.batch_result = true,
+                                       .output_controls = std::move(output_controls),
+                                       .control_results = std::move(batch.m_reports)};
+}
+
+// The callback is only set before the batch is dispatched, so it can be called without holding the state of the batch
+void output_scheduler::finish_batch(batch_state &batch, batch_output_control_result result) {
+    if (batch.m_on_finished) {
+        batch.m_on_finished(std::move(result));
+    }
+}
+
+output_scheduler::worker_queue::worker_queue(output_scheduler &scheduler, std::string type, size_t number_of_workers)
+    : m_scheduler(scheduler), m_type(std::move(type)) {
+    m_worker_threads.reserve(number_of_workers);
+
+    for (size_t i = 0; i < number_of_workers; ++i) {
+        m_worker_threads.emplace_back(&worker_queue::process_tasks, this);
+    }
+}
+
+output_scheduler::worker_queue::~worker_queue() {
+    {
+        std::lock_guard<std::mutex> tasks_guard{m_tasks_mutex};
+        m_should_exit = true;
+    }
+
+    m_tasks_changed.notify_all();
+
+    for (auto &current_worker : m_worker_threads) {
+        current_worker.join();
+    }
+}
+
+void output_scheduler::worker_queue::push(output_task task) {
+    {
+        std::lock_guard<std::mutex> tasks_guard{m_tasks_mutex};
+        m_tasks.emplace_back(std::move(task));
+    }
+
+    m_tasks_changed.notify_one();
+}
+
+output_queue_statistics output_scheduler::worker_queue::statistics() const {
+    std::lock_guard<std::mutex> tasks_guard{m_tasks_mutex};
+    return output_queue_statistics{.type = m_type,
+                                   .number_of_workers = m_worker_threads.size(),
+                                   .queue_depth = m_tasks.size(),
+                                   .executed_tasks = m_executed_tasks,
+                                   .cancelled_tasks = m_cancelled_tasks,
+                                   .last_dispatch_latency = m_last_dispatch_latency,
+                                   .max_dispatch_latency = m_max_dispatch_latency};
+}
+
+// The oldest task, whose outputs aren't controlled by another worker at the moment. The outputs of older tasks, which
+// are still waiting, are blocked as well, so the tasks of an output are always executed in the order they were queued
+auto output_scheduler::worker_queue::find_runnable_task() -> std::deque<output_task>::iterator {
+    std::set<output_handle> blocked_outputs = m_busy_outputs;
+
+    for (auto current_task = m_tasks.begin(); current_task != m_tasks.end(); ++current_task) {
+        bool is_blocked = std::any_of(current_task->m_outputs.cbegin(), current_task->m_outputs.cend(),
+                                      [&blocked_outputs](auto output) { return blocked_outputs.count(output) != 0; });
+
+        if (!is_blocked) {
+            return current_task;
+        }
+
+        blocked_outputs.insert(current_task->m_outputs.cbegin(), current_task->m_outputs.cend());
+    }
+
+    return m_tasks.end();
+}
+
+// Tasks which are already queued are still executed on exit, so no batch is left without a result
+void output_scheduler::worker_queue::process_tasks() {
+    std::unique_lock<std::mutex> tasks_guard{m_tasks_mutex};
+
+    while (true) {
+        m_tasks_changed.wait(tasks_guard, [this]() {
+            return (m_should_exit && m_tasks.empty()) || find_runnable_task() != m_tasks.end();
+        });
+
+        if (m_tasks.empty()) {
+            return;
+        }
+
+        auto runnable_task = find_runnable_task();
+        auto current_task = std::move(*runnable_task);
+        m_tasks.erase(runnable_task);
+        m_busy_outputs.insert(current_task.m_outputs.cbegin(), current_task.m_outputs.cend());
+
+        m_last_dispatch_latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - current_task.m_queued_at);
+        m_max_dispatch_latency = std::max(m_max_dispatch_latency, m_last_dispatch_latency);
+
+        tasks_guard.unlock();
+        bool is_cancelled = false;
+
+        {
+            // Tasks of batches, which already timed out, aren't started anymore
+            auto &batch = *current_task.m_batch;
+            std::lock_guard<std::mutex> state_guard{batch.m_state_mutex};
+            is_cancelled = batch.m_is_finished || batch.m_task_done[current_task.m_task_index];
+        }
+
+        if (!is_cancelled) {
+            m_scheduler.execute_task(current_task);
+        }
+        tasks_guard.lock();
+
+        for (auto output : current_task.m_outputs) {
+            m_busy_outputs.erase(output);
+        }
+        ++(is_cancelled ? m_cancelled_tasks : m_executed_tasks);
+
+        // Tasks of the outputs, which were just controlled, might be runnable now
+        m_tasks_changed.notify_all();
+    }
 }
@@ -1,14 +1,22 @@
 #include "io/outputs/outputs.h"
 
+#include <set>
+#include <typeindex>
+
+#include "io/outputs/output_change_bus.h"
+#include "io/outputs/write_suppressed_output.h"
 #include "logger.h"
+#include "utils.h"
 
 bool outputs::add_output(nlohmann::json &gpio_description) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+    std::unique_lock<std::shared_mutex> list_guard{_list_mutex};
     auto logger_instance = logger::instance();
 
     json id_entry = gpio_description["id"];
     json type_entry = gpio_description["type"];
     json description_entry = gpio_description["description"];
+    json suppress_writes_entry = gpio_description["suppress_writes"];
+    json resync_interval_entry = gpio_description["resync_interval"];
 
     if (id_entry.is_null() || type_entry.is_null() || description_entry.is_null()) {
         logger_instance->critical("A needed entry in a output entry was missing {} {} {}",
@@ -27,7 +35,7 @@ bool outputs::add_output(nlohmann::json &gpio_description) {
 
     std::string id = id_entry.get<std::string>();
 
-    if (is_valid_id(id)) {
+    if (find_entry(id) != nullptr) {
         logger_instance->critical("The id {} for a gpio entry is already in use", id);
         return false;
     }
@@ -49,88 +57,247 @@ bool outputs::add_output(nlohmann::json &gpio_description) {
         return false;
     }
 
-    _outputs.emplace(std::make_pair(id, std::move(created_output)));
+    // Writes of unchanged values are skipped, unless the output opts out (e.g. if it is changed by somebody else)
+    if (suppress_writes_entry.is_null() || (suppress_writes_entry.is_boolean() && suppress_writes_entry.get<bool>())) {
+        auto resync_interval = _default_resync_interval;
+
+        if (resync_interval_entry.is_string()) {
+            auto parsed_interval =
+                parse_duration<std::chrono::milliseconds>(resync_interval_entry.get<std::string>());
+
+            if (!parsed_interval.has_value()) {
+                logger_instance->critical("The resync interval of the output entry {} is invalid", id);
+                return false;
+            }
+
+            resync_interval = *parsed_interval;
+        }
+
+        created_output = std::make_unique<write_suppressed_output>(std::move(created_output), resync_interval);
+    }
+
+    auto handle = output_handle(_outputs.size());
+    created_output->on_value_changed([handle](const output_value &value) {
+        output_change_bus::publish(handle, value, output_change_source::transition);
+    });
+
+    _output_handles.emplace(id, handle);
+    _outputs.push_back(output_entry{id, type_entry.get<std::string>(), std::move(created_output),
+                                    std::make_unique<std::mutex>(), handle});
     return true;
 }
 
-auto outputs::find_output(const output_id &id) -> outputs_map_type::iterator {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
-    return std::find_if(_outputs.begin(), _outputs.end(),
-                        [&id](const auto &current_output) { return current_output.first == id; });
+auto outputs::find_entry(const output_id &id) -> output_entry * {
+    auto result = _output_handles.find(id);
+
+    if (result == _output_handles.cend()) {
+        return nullptr;
+    }
+
+    return find_entry(result->second);
 }
 
-bool outputs::is_valid_id(const output_id &id) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
-    return find_output(id) != _outputs.cend();
+auto outputs::find_entry(const output_handle &handle) -> output_entry * {
+    if (static_cast<size_t>(handle) >= _outputs.size()) {
+        return nullptr;
+    }
+
+    return &_outputs[static_cast<size_t>(handle)];
 }
 
-bool outputs::control_output(const output_id &id, const output_value &value) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+template<typename Func>
+std::optional<std::invoke_result_t<Func, output_interface &>> outputs::with_output(const output_id &id, Func func) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
 
-    auto output = find_output(id);
+    auto entry = find_entry(id);
 
-    if (output == _outputs.cend() || (*output).second == nullptr) {
-        return false;
+    if (entry == nullptr) {
+        return {};
     }
 
-    return ((*output).second)->control_output(value);
+    std::lock_guard<std::mutex> output_guard{*entry->m_output_mutex};
+    return func(*entry->m_output);
 }
 
-std::optional<output_value> outputs::is_overriden(const output_id &id) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+template<typename Func>
+std::optional<std::invoke_result_t<Func, output_interface &>> outputs::with_output(const output_handle &handle,
+                                                                                   Func func) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
 
-    auto output = find_output(id);
+    auto entry = find_entry(handle);
 
-    if (output == _outputs.cend() || (*output).second == nullptr) {
+    if (entry == nullptr) {
         return {};
     }
 
-    return ((*output).second)->is_overriden();
+    std::lock_guard<std::mutex> output_guard{*entry->m_output_mutex};
+    return func(*entry->m_output);
 }
 
-bool outputs::override_with(const output_id &id, const output_value &value) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+template<typename Key, typename Func>
+bool outputs::change_output(const Key &key, output_change_source source, Func func) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
 
-    auto output = find_output(id);
+    auto entry = find_entry(key);
 
-    if (output == _outputs.cend() || (*output).second == nullptr) {
+    if (entry == nullptr) {
         return false;
     }
 
-    return ((*output).second)->override_with(value);
+    std::lock_guard<std::mutex> output_guard{*entry->m_output_mutex};
+
+    if (!func(*entry->m_output)) {
+        return false;
+    }
+
+    // Published while the output is locked, so the changes of one output are published in order
+    if (output_change_bus::has_subscribers()) {
+        output_change_bus::publish(entry->m_handle, entry->m_output->current_state(), source);
+    }
+
+    return true;
 }
 
-bool outputs::restore_control(const output_id &id) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+std::optional<output_handle> outputs::find_handle(const output_id &id) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
 
-    auto output = find_output(id);
+    if (auto result = _output_handles.find(id); result != _output_handles.cend()) {
+        return result->second;
+    }
 
-    if (output == _outputs.cend() || (*output).second == nullptr) {
-        return false;
+    return {};
+}
+
+std::optional<output_id> outputs::id_of(const output_handle &handle) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+
+    if (auto entry = find_entry(handle); entry != nullptr) {
+        return entry->m_id;
     }
 
-    return ((*output).second)->restore_control();
+    return {};
 }
 
-std::optional<output_value> outputs::current_state(const output_id &id) {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+std::optional<std::string> outputs::type_of(const output_handle &handle) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
 
-    auto output = find_output(id);
+    if (auto entry = find_entry(handle); entry != nullptr) {
+        return entry->m_type;
+    }
 
-    if (output == _outputs.cend() || (*output).second == nullptr) {
-        return {};
+    return {};
+}
+
+size_t outputs::number_of_outputs() {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+    return _outputs.size();
+}
+
+bool outputs::is_valid_id(const output_id &id) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+    return find_entry(id) != nullptr;
+}
+
+bool outputs::control_output(const output_id &id, const output_value &value) {
+    return change_output(id, output_change_source::control,
+                         [&value](auto &output) { return output.control_output(value); });
+}
+
+bool outputs::control_output(const output_handle &handle, const output_value &value) {
+    return change_output(handle, output_change_source::control,
+                         [&value](auto &output) { return output.control_output(value); });
+}
+
+std::vector<bool> outputs::control_outputs(const std::vector<std::pair<output_handle, output_value>> &controls) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+    std::vector<bool> results(controls.size(), false);
+
+    // Wrapped and unwrapped outputs of one driver are different types, so a driver only ever gets its own outputs
+    std::map<std::pair<const void *, std::type_index>, std::vector<size_t>> controls_per_driver;
+
+    for (size_t i = 0; i < controls.size(); ++i) {
+        auto entry = find_entry(controls[i].first);
+
+        if (entry == nullptr) {
+            continue;
+        }
+
+        const void *driver = entry->m_output->batch_driver();
+        auto &output = *entry->m_output;
+        controls_per_driver[std::make_pair(driver != nullptr ? driver : entry, std::type_index(typeid(output)))]
+            .emplace_back(i);
+    }
+
+    for (const auto &[driver, driver_controls] : controls_per_driver) {
+        // The outputs are locked in the order of their handles, so concurrent batches can't deadlock
+        std::set<output_handle> handles;
+        std::vector<std::unique_lock<std::mutex>> output_guards;
+        output_interface::output_batch batch;
+        batch.reserve(driver_controls.size());
+
+        for (auto current_index : driver_controls) {
+            const auto &[handle, value] = controls[current_index];
+            handles.insert(handle);
+            batch.emplace_back(find_entry(handle)->m_output.get(), value);
+        }
+
+        for (auto current_handle : handles) {
+            output_guards.emplace_back(*find_entry(current_handle)->m_output_mutex);
+        }
+
+        auto batch_results = batch.front().first->control_outputs(batch);
+
+        for (size_t i = 0; i < driver_controls.size(); ++i) {
+            auto handle = controls[driver_controls[i]].first;
+            results[driver_controls[i]] = i < batch_results.size() && batch_results[i];
+
+            if (results[driver_controls[i]] && output_change_bus::has_subscribers()) {
+                output_change_bus::publish(handle, batch[i].first->current_state(), output_change_source::control);
+            }
+        }
+    }
+
+    return results;
+}
+
+std::optional<const void *> outputs::batch_driver_of(const output_handle &handle) {
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
+
+    if (auto entry = find_entry(handle); entry != nullptr) {
+        return entry->m_output->batch_driver();
     }
 
-    return ((*output).second)->current_state();
+    return {};
+}
+
+std::optional<output_value> outputs::is_overriden(const output_id &id) {
+    return with_output(id, [](auto &output) { return output.is_overriden(); }).value_or(std::nullopt);
+}
+
+bool outputs::override_with(const output_id &id, const output_value &value) {
+    return change_output(id, output_change_source::override,
+                         [&value](auto &output) { return output.override_with(value); });
+}
+
+bool outputs::restore_control(const output_id &id) {
+    return change_output(id, output_change_source::restore, [](auto &output) { return output.restore_control(); });
+}
+
+std::optional<output_value> outputs::current_state(const output_id &id) {
+    return with_output(id, [](auto &output) { return output.current_state(); });
+}
+
+std::optional<output_value> outputs::current_state(const output_handle &handle) {
+    return with_output(handle, [](auto &output) { return output.current_state(); });
 }
 
 std::vector<output_id> outputs::get_ids() {
-    std::lock_guard<std::recursive_mutex> list_guard{_list_mutex};
+    std::shared_lock<std::shared_mutex> list_guard{_list_mutex};
 
     std::vector<output_id> ids;
-    ids.reserve(_outputs.size());
+    ids.reserve(_output_handles.size());
 
-    for (auto &[id, iterator] : _outputs) {
+    for (auto &[id, handle] : _output_handles) {
         ids.emplace_back(id);
     }
 
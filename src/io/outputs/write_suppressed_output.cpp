@@ -0,0 +1,123 @@
+#include "io/outputs/write_suppressed_output.h"
+
+#include <map>
+
+write_suppressed_output::write_suppressed_output(std::unique_ptr<output_interface> output,
+                                                 std::chrono::milliseconds resync_interval)
+    : m_output(std::move(output)), m_resync_interval(resync_interval) {}
+
+bool write_suppressed_output::control_output(const output_value &value) {
+    if (m_confirmed_control == value && !is_resync_due()) {
+        ++m_suppressed_writes;
+        return true;
+    }
+
+    if (!confirm_write(m_output->control_output(value))) {
+        return false;
+    }
+
+    m_confirmed_control = value;
+    return true;
+}
+
+std::vector<bool> write_suppressed_output::control_outputs(const output_batch &batch) {
+    std::vector<bool> results(batch.size(), true);
+    std::vector<size_t> written_controls;
+    output_batch wrapped_batch;
+    // An output can be controlled more than once in a batch, later controls are compared with the earlier ones
+    std::map<write_suppressed_output *, output_value> written_values;
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto &suppressed_output = static_cast<write_suppressed_output &>(*batch[i].first);
+        const auto &value = batch[i].second;
+
+        if (auto written_value = written_values.find(&suppressed_output); written_value != written_values.cend()) {
+            if (written_value->second == value) {
+                ++suppressed_output.m_suppressed_writes;
+                continue;
+            }
+        } else if (suppressed_output.m_confirmed_control == value && !suppressed_output.is_resync_due()) {
+            ++suppressed_output.m_suppressed_writes;
+            continue;
+        }
+
+        written_values.insert_or_assign(&suppressed_output, value);
+        written_controls.emplace_back(i);
+        wrapped_batch.emplace_back(suppressed_output.m_output.get(), value);
+    }
+
+    if (wrapped_batch.empty()) {
+        return results;
+    }
+
+    auto wrapped_results = wrapped_batch.front().first->control_outputs(wrapped_batch);
+
+    for (size_t i = 0; i < written_controls.size(); ++i) {
+        auto &suppressed_output = static_cast<write_suppressed_output &>(*batch[written_controls[i]].first);
+        results[written_controls[i]] = suppressed_output.confirm_write(wrapped_results[i]);
+
+        if (results[written_controls[i]]) {
+            suppressed_output.m_confirmed_control = batch[written_controls[i]].second;
+        }
+    }
+
+    return results;
+}
+
+bool write_suppressed_output::override_with(const output_value &value) {
+    if (m_confirmed_override == value && !is_resync_due()) {
+        ++m_suppressed_writes;
+        return true;
+    }
+
+    if (!confirm_write(m_output->override_with(value))) {
+        return false;
+    }
+
+    m_confirmed_override = value;
+    return true;
+}
+
+bool write_suppressed_output::restore_control() {
+    // Without an override the output already has the controlled value
+    if (!m_confirmed_override.has_value() && m_confirmed_control.has_value() && !m_output->is_overriden().has_value() &&
+        !is_resync_due()) {
+        ++m_suppressed_writes;
+        return true;
+    }
+
+    if (!confirm_write(m_output->restore_control())) {
+        return false;
+    }
+
+    m_confirmed_override.reset();
+    return true;
+}
+
+std::optional<output_value> write_suppressed_output::is_overriden() const { return m_output->is_overriden(); }
+
+output_value write_suppressed_output::current_state() const { return m_output->current_state(); }
+
+void write_suppressed_output::on_value_changed(change_callback callback) {
+    m_output->on_value_changed(std::move(callback));
+}
+
+const void *write_suppressed_output::batch_driver() const { return m_output->batch_driver(); }
+
+size_t write_suppressed_output::suppressed_writes() const { return m_suppressed_writes; }
+
+bool write_suppressed_output::is_resync_due() const {
+    return !m_last_write.has_value() || std::chrono::steady_clock::now() - *m_last_write >= m_resync_interval;
+}
+
+bool write_suppressed_output::confirm_write(bool write_result) {
+    if (!write_result) {
+        m_confirmed_control.reset();
+        m_confirmed_override.reset();
+        m_last_write.reset();
+        return false;
+    }
+
+    m_last_write = std::chrono::steady_clock::now();
+    return true;
+}
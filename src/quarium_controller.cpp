@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <string>
 
@@ -8,7 +9,9 @@
 #endif
 
 #include "config.h"
+#include "io/inputs/inputs.h"
 #include "io/interfaces/gpio/gpio_chip.h"
+#include "io/interfaces/gpio/gpio_input.h"
 #include "io/interfaces/mqtt/mqtt.h"
 #include "io/outputs/can/can_output.h"
 #include "io/outputs/mqtt/mqtt_output.h"
@@ -79,6 +82,23 @@ int main(int argc, char *argv[]) {
     output_factory::register_interface("can", &can_output::create_for_interface);
     output_factory::register_interface("mqtt", &mqtt_output::create_for_interface);
 
+    // Register input interfaces
+    input_factory::register_interface("gpio", &gpio_input::create_for_interface);
+
+    // Inputs are optional, they are described by the configuration, because they don't depend on the schedule
+    auto input_descriptions = conf->find("inputs");
+
+    if (!input_descriptions.is_null()) {
+        bool successfully_parsed_all_inputs =
+            std::all_of(input_descriptions.begin(), input_descriptions.end(),
+                        [](auto &current_input_description) { return inputs::add_input(current_input_description); });
+
+        if (!successfully_parsed_all_inputs) {
+            logger_instance->critical("One or more descriptions of inputs contain errors");
+            return EXIT_FAILURE;
+        }
+    }
+
     auto schedule_file_paths = conf->find("schedule_list");
 
     if (schedule_file_paths.size() == 0) {
@@ -266,6 +266,12 @@ bool schedule::add_event(const schedule_event &event) {
     return true;
 }
 
+// Has to be called after all events are added, the timeline isn't updated by add_event
+schedule &schedule::compile_timeline() {
+    m_timeline = schedule_timeline::compile(m_events);
+    return *this;
+}
+
 void schedule::recalculate_period() {
     if (m_start_at.has_value() && m_end_at.has_value()) {
         if (m_end_at.value() > m_start_at.value()) {
@@ -297,6 +303,10 @@ schedule::mode schedule::schedule_mode() const { return m_mode; }
 
 const std::vector<schedule_event> &schedule::events() const { return m_events; }
 
+schedule_timeline &schedule::timeline() { return m_timeline; }
+
+const schedule_timeline &schedule::timeline() const { return m_timeline; }
+
 // TODO log issues with schedule
 schedule::operator bool() const {
     if (m_start_at.has_value() && !m_end_at.has_value()) {
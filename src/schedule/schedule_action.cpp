@@ -1,6 +1,7 @@
 #include "schedule/schedule_action.h"
 
 #include <future>
+#include <numeric>
 
 #include "io/outputs/output_scheduler.h"
 #include "logger.h"
@@ -106,118 +107,142 @@ bool schedule_action::add_action(json &schedule_action_description) {
         created_action.attach_output(current_output_value_pair);
     }
 
+    auto created_handle = schedule_action_handle(_actions.size());
     _actions.emplace_back(std::make_unique<schedule_action>(std::move(created_action)));
+    _action_handles.emplace(id, created_handle);
 
     return true;
 }
 
 bool schedule_action::is_valid_id(const schedule_action_id &id) {
     std::lock_guard<std::recursive_mutex> instance_guard{_instance_mutex};
-    return std::find_if(_actions.cbegin(), _actions.cend(),
-                        [&id](const auto &current_action) { return current_action->id() == id; }) != _actions.cend();
+    return find_handle(id).has_value();
 }
 
-// Actions will be executed in order, actions that will cancel each other will be optimized -> first action turns on
-// second action turns off, then only the second one will be executed
-std::vector<schedule_action_id> schedule_action::execute_actions(const std::vector<schedule_action_id> &ids) {
-    struct schedule_action_execution_order {
-        const std::vector<schedule_action_id>::const_reverse_iterator m_action_id;
-        const output_value m_value;
-    };
-
+std::optional<schedule_action_handle> schedule_action::find_handle(const schedule_action_id &id) {
     std::lock_guard<std::recursive_mutex> instance_guard{_instance_mutex};
 
-    // Mark all actions as failed and remove if the action was successfull
-    std::vector<schedule_action_id> failed_actions;
-    failed_actions.reserve(ids.size());
-    std::copy(ids.cbegin(), ids.cend(), std::back_inserter(failed_actions));
-
-    if (ids.size() == 0) {
-        return failed_actions;
+    if (auto result = _action_handles.find(id); result != _action_handles.cend()) {
+        return result->second;
     }
 
-    auto logger_instance = logger::instance();
+    return {};
+}
 
-    batch_output_control control_job;
-    control_job.optimize_outputs(true);
+std::vector<schedule_action_id> schedule_action::execute_actions(const std::vector<schedule_action_id> &ids) {
+    std::vector<schedule_action_handle> handles;
+    handles.reserve(ids.size());
 
     for (const auto &current_id : ids) {
-        if (!is_valid_id(current_id)) {
-            logger_instance->warn("{} is not a valid id for an action", current_id);
-            return failed_actions;
-        }
-
-        const auto action = std::find_if(_actions.cbegin(), _actions.cend(),
-                                         [&current_id](const auto &action) { return action->id() == current_id; });
+        auto handle = find_handle(current_id);
 
-        if ((*action) == nullptr) {
-            continue;
+        if (!handle.has_value()) {
+            logger::instance()->warn("{} is not a valid id for an action", current_id);
+            return ids;
         }
 
-        control_job.add_output_controls((*action)->m_outputs);
+        handles.emplace_back(*handle);
     }
 
-    auto output_control_future = output_scheduler::execute_batch_output_control(control_job);
+    auto failed_positions = execute_actions(handles);
+
+    std::vector<schedule_action_id> failed_actions;
+    failed_actions.reserve(failed_positions.size());
 
-    // TODO: add real timeout, don't wait for the result an undefined amount of time
-    while (!output_control_future.valid()) {
-        output_control_future.wait_for(std::chrono::seconds(10));
+    for (auto current_position : failed_positions) {
+        failed_actions.emplace_back(ids[current_position]);
     }
 
-    auto output_control_results = output_control_future.get();
+    return failed_actions;
+}
 
-    for (const auto &[output_control, control_result] : output_control_results.control_results) {
-        if (control_result == output_control_result::skipped) {
-            logger_instance->info("Skipped setting output {}", output_control.first);
-        } else if (control_result == output_control_result::failure) {
-            logger_instance->info("Failed setting output {}", output_control.first);
-        }
+std::vector<size_t> schedule_action::execute_actions(const std::vector<schedule_action_handle> &handles) {
+    auto result_promise = std::make_shared<std::promise<std::vector<size_t>>>();
+    auto result_future = result_promise->get_future();
+
+    execute_actions(handles, [result_promise](std::vector<size_t> failed_positions) {
+        result_promise->set_value(std::move(failed_positions));
+    });
+
+    // The output_scheduler reports all unfinished controls as timed out, when the timeout of the batch has passed, this
+    // is only a safety net
+    if (result_future.wait_for(batch_output_control().timeout() + _result_grace_period) !=
+        std::future_status::ready) {
+        logger::instance()->critical("Didn't receive the result of the output controls in time");
+
+        std::vector<size_t> failed_actions(handles.size());
+        std::iota(failed_actions.begin(), failed_actions.end(), 0);
+        return failed_actions;
     }
 
-    // TODO: remove ids from failed_actions, when no output could be found, which failed
-    auto new_failure_end =
-        std::remove_if(failed_actions.begin(), failed_actions.end(), [&output_control_results](const auto &current_id) {
-            auto current_action =
-                std::find_if(_actions.cbegin(), _actions.cend(),
-                             [&current_id](const auto &current_action) { return current_action->id() == current_id; });
+    return result_future.get();
+}
 
-            // Is not part of the valid actions, shouldn't happen
-            if (current_action == _actions.cend()) {
-                return false;
+// Actions will be executed in order, actions that will cancel each other will be optimized -> first action turns on
+// second action turns off, then only the second one will be executed
+void schedule_action::execute_actions(const std::vector<schedule_action_handle> &handles,
+                                      actions_callback on_finished) {
+    auto logger_instance = logger::instance();
+
+    batch_output_control control_job;
+    control_job.optimize_outputs(true);
+
+    {
+        std::lock_guard<std::recursive_mutex> instance_guard{_instance_mutex};
+
+        for (size_t i = 0; i < handles.size(); ++i) {
+            if (static_cast<size_t>(handles[i]) >= _actions.size()) {
+                logger_instance->warn("{} is not a valid handle for an action", static_cast<uint32_t>(handles[i]));
+
+                // Mark all actions as failed, the batch can't be executed at all
+                std::vector<size_t> failed_actions(handles.size());
+                std::iota(failed_actions.begin(), failed_actions.end(), 0);
+                on_finished(std::move(failed_actions));
+                return;
             }
 
-            const auto &action_outputs = (*current_action)->m_outputs;
-
-            // Check if every output of the action was successfully controlled or skipped
-            return std::all_of(action_outputs.cbegin(), action_outputs.cend(),
-                               [&output_control_results](const auto &current_controlled_output) {
-                                   return std::all_of(
-                                       output_control_results.control_results.cbegin(),
-                                       output_control_results.control_results.cend(),
-                                       [&current_controlled_output](const auto &current_result) {
-                                           return current_controlled_output.first != current_result.first.first ||
-                                                  current_result.second != output_control_result::failure;
-                                       });
-                               });
-        });
+            const auto &action = _actions[static_cast<size_t>(handles[i])];
 
-    if (new_failure_end != failed_actions.cend()) {
-        failed_actions.erase(new_failure_end, failed_actions.end());
+            if (action == nullptr) {
+                continue;
+            }
+
+            // The position of the action is the origin of its output controls, so failures can be mapped back
+            // directly
+            control_job.add_output_controls(action->m_output_controls, i);
+        }
     }
 
-    return failed_actions;
+    output_scheduler::execute_batch_output_control(
+        control_job, [number_of_actions = handles.size(),
+                      on_finished = std::move(on_finished)](batch_output_control_result output_control_results) {
+            auto logger_instance = logger::instance();
+
+            for (const auto &current_report : output_control_results.control_results) {
+                auto output = outputs::id_of(current_report.control.first).value_or("");
+
+                if (current_report.result == output_control_result::skipped) {
+                    logger_instance->info("Skipped setting output {}", output);
+                } else if (current_report.result == output_control_result::failure) {
+                    logger_instance->info("Failed setting output {}", output);
+                } else if (current_report.result == output_control_result::timed_out) {
+                    // The control might still be applied later on, the action is retried like a failed one anyway
+                    logger_instance->info("Timed out setting output {}", output);
+                }
+            }
+
+            on_finished(output_control_results.failed_origins(number_of_actions));
+        });
 }
 
 schedule_action::schedule_action(schedule_action &&other)
-    : m_id(std::move(other.m_id)), m_outputs(std::move(other.m_outputs)) {
+    : m_id(std::move(other.m_id)),
+      m_outputs(std::move(other.m_outputs)),
+      m_output_controls(std::move(other.m_output_controls)) {
     std::lock_guard<std::recursive_mutex> instance_guard{_instance_mutex};
 
-    if (is_valid_id(m_id)) {
-        std::string id = m_id;
-        auto action = std::find_if(_actions.begin(), _actions.end(),
-                                   [&id](const auto &current_action) { return current_action->id() == id; });
-
-        *action = std::unique_ptr<schedule_action>(this);
+    if (auto handle = find_handle(m_id); handle.has_value()) {
+        _actions[static_cast<size_t>(*handle)] = std::unique_ptr<schedule_action>(this);
     }
 }
 
@@ -228,6 +253,11 @@ schedule_action &schedule_action::id(const schedule_action_id &new_id) {
 
 schedule_action &schedule_action::attach_output(const std::pair<output_id, output_value> &new_output) {
     m_outputs.emplace_back(new_output);
+
+    if (auto handle = outputs::find_handle(new_output.first); handle.has_value()) {
+        m_output_controls.emplace_back(*handle, new_output.second);
+    }
+
     return *this;
 }
 
@@ -31,6 +31,7 @@ void schedule_handler::stop_event_handler() {
     }
 
     m_should_exit.store(true);
+    wake_up_event_handler();
     m_event_thread.join();
     m_is_started = false;
 }
@@ -65,142 +66,290 @@ bool schedule_handler::add_schedule(schedule sched) {
     {
         auto lock = singleton<schedule_handler>::retrieve_instance_lock();
         logger_instance->info("Added schedule {} to the list of schedules", sched.title());
+        sched.compile_timeline();
         m_inactive_schedules.emplace_back(std::move(sched));
     }
 
+    m_schedules_changed.store(true);
+    wake_up_event_handler();
+
     return true;
 }
 
+void schedule_handler::wake_up_event_handler() {
+    // Take the lock, so the notification can't get lost between the check of the predicate and the wait
+    { std::lock_guard<std::mutex> wake_up_guard{m_wake_up_mutex}; }
+    m_wake_up.notify_all();
+}
+
+bool schedule_handler::is_later_deadline::operator()(const schedule_deadline &lhs,
+                                                     const schedule_deadline &rhs) const {
+    return lhs.m_trigger_at > rhs.m_trigger_at;
+}
+
+std::optional<std::chrono::seconds> schedule_handler::next_trigger_time(const schedule &sched) {
+    if (!sched.start_at().has_value()) {
+        return {};
+    }
+
+    std::optional<std::chrono::seconds> next_trigger_at;
+
+    if (auto next_trigger = sched.timeline().next_trigger_time(); next_trigger.has_value()) {
+        next_trigger_at = std::chrono::duration_cast<std::chrono::seconds>(sched.start_at().value() +
+                                                                           next_trigger->first) +
+                          next_trigger->second;
+    }
+
+    // Failed events are due at their retry time, unless an earlier event of the schedule takes them with it
+    if (auto next_retry_at = sched.timeline().next_retry_time();
+        next_retry_at.has_value() && (!next_trigger_at.has_value() || *next_retry_at < *next_trigger_at)) {
+        next_trigger_at = next_retry_at;
+    }
+
+    return next_trigger_at;
+}
+
 void schedule_handler::event_handler() {
-    signal_handler::disable_for_current_thread();
-    std::vector<schedule_action_id> actions_to_execute;
-    std::vector<bool> execution_results;
-    std::multimap<schedule_action_id,
-                  std::decay_t<decltype(std::declval<rest_resource_id<schedule_event>>().as_number())>>
-        actions_to_event_mapping;
-    auto logger_instance = logger::instance();
+    using namespace std::chrono_literals;
 
+    signal_handler::disable_for_current_thread();
     auto handler_instance = instance();
+    std::optional<days> last_update_day{};
 
     while (!handler_instance->m_should_exit.load()) {
+        std::chrono::seconds time_until_next_deadline{0};
+
         {
             auto lock = singleton<schedule_handler>::retrieve_instance_lock();
 
-            auto minutes_since_today = duration_since_epoch<std::chrono::minutes>() - duration_since_epoch<days>();
             auto current_day = duration_since_epoch<days>();
+            auto now = duration_since_epoch<std::chrono::seconds>();
+            auto &deadlines = handler_instance->m_deadlines;
+            auto &current_deadlines = handler_instance->m_current_deadlines;
 
-            for (const auto &current_schedule : handler_instance->m_active_schedules) {
-                actions_to_execute.clear();
-                execution_results.clear();
-                actions_to_event_mapping.clear();
+            handler_instance->m_deadlines_changed.store(false);
 
-                logger_instance->info("Checking events of schedule {}", current_schedule.title());
+            // Only the schedules with due events are checked, all the other ones are left alone
+            while (!deadlines.empty() && deadlines.top().m_trigger_at <= now) {
+                auto [trigger_at, due_schedule_index] = deadlines.top();
+                deadlines.pop();
 
-                if (!current_schedule.start_at().has_value()) {
+                if (current_deadlines[due_schedule_index] != trigger_at) {
                     continue;
                 }
 
-                auto day_in_schedule = current_day - current_schedule.start_at().value();
-
-                // TODO: when the clock is set to an earlier timepoint this code won't behave correctly
-                for (const auto &current_event : current_schedule.events()) {
-                    if ((current_event.day() > day_in_schedule) ||
-                        (current_event.trigger_time() > minutes_since_today) || current_event.is_processed()) {
-                        continue;
-                    }
-
-                    logger_instance->info("Scheduling actions of : {} id : {} for execution", current_event.name(),
-                                          current_event.id().as_number());
+                current_deadlines[due_schedule_index].reset();
 
-                    for (auto &current_action_id : current_event.actions()) {
-                        actions_to_execute.emplace_back(current_action_id);
-                        actions_to_event_mapping.insert({current_action_id, current_event.id().as_number()});
-                    }
+                // The actions are executed asynchronously, failed events are scheduled for a retry by the callback
+                auto &current_schedule = handler_instance->m_active_schedules[due_schedule_index];
+                handler_instance->process_due_events(current_schedule, current_day, now);
 
-                    current_event.mark_as_processed();
+                // The callback may have been called directly and already scheduled a retry
+                if (current_deadlines[due_schedule_index].has_value()) {
+                    continue;
                 }
 
-                // Actions are in order, because the events are in order (sorted by event time on a per day basis)
-                auto failed_actions = schedule_action::execute_actions(actions_to_execute);
-
-                if (failed_actions.size() > 0) {
-                    logger_instance->warn("Some actions couldn't be executed");
-                    // Find the corresponding events to the failed actions and remove their processed mark
-                    std::vector<std::decay_t<decltype(std::declval<rest_resource_id<schedule_event>>().as_number())>>
-                        failed_events;
-                    for (const auto &current_failed_action_id : failed_actions) {
-                        auto failed_events_of_action = actions_to_event_mapping.equal_range(current_failed_action_id);
-
-                        for (auto it = failed_events_of_action.first; it != failed_events_of_action.second; ++it) {
-                            failed_events.emplace_back(it->second);
-                        }
-                    }
-
-                    for (auto const &current_event : current_schedule.events()) {
-                        auto current_event_id = current_event.id().as_number();
-                        if (std::any_of(
-                                failed_events.cbegin(), failed_events.cend(),
-                                [current_event_id](auto &current_id) { return current_id == current_event_id; })) {
-                            // Some actions or all the actions of this event were unsuccesfull unmark as processed, so
-                            // the are actions can be tried again
-                            current_event.unmark_as_processed();
-                            logger_instance->critical("One or more actions of the event {} resulted in errors",
-                                                      current_event.name());
-                        }
-                    }
-
-                    logger_instance->critical("Failed to execute some actions of schedule {}",
-                                              current_schedule.title());
+                if (auto next_trigger_at = next_trigger_time(current_schedule); next_trigger_at.has_value()) {
+                    handler_instance->push_deadline(due_schedule_index, *next_trigger_at);
                 }
             }
 
-            std::vector<schedule> to_be_added_back;
+            if (handler_instance->m_schedules_changed.exchange(false) || last_update_day != current_day) {
+                handler_instance->update_active_schedules(current_day);
+                handler_instance->rebuild_deadlines();
+                last_update_day = current_day;
+            }
+
+            // The list of active schedules has to be updated at the start of every day
+            auto next_deadline = std::chrono::duration_cast<std::chrono::seconds>(current_day + days(1));
 
-            auto activate_schedules = std::remove_if(
-                handler_instance->m_inactive_schedules.begin(), handler_instance->m_inactive_schedules.end(),
-                [&current_day](const auto &current_schedule) {
-                    return current_schedule.schedule_mode() == schedule::mode::repeating ||
-                           current_schedule.end_at() >= current_day;
-                });
+            if (!deadlines.empty()) {
+                next_deadline = std::min(next_deadline, deadlines.top().m_trigger_at);
+            }
 
-            for (auto current_schedule = activate_schedules;
-                 current_schedule != handler_instance->m_inactive_schedules.cend(); ++current_schedule) {
-                auto created_schedule(*current_schedule);
+            time_until_next_deadline = std::clamp(next_deadline - now, 0s, _max_sleep_time);
+        }
 
-                for (const auto &current_event : created_schedule.events()) {
-                    current_event.unmark_as_processed();
-                }
+        std::unique_lock<std::mutex> wake_up_guard{handler_instance->m_wake_up_mutex};
+        handler_instance->m_wake_up.wait_for(wake_up_guard, time_until_next_deadline, [&handler_instance]() {
+            return handler_instance->m_should_exit.load() || handler_instance->m_schedules_changed.load() ||
+                   handler_instance->m_deadlines_changed.load();
+        });
+    }
+}
 
-                if (current_schedule->end_at() < current_day &&
-                    created_schedule.schedule_mode() == schedule::mode::repeating) {
-                    created_schedule.start_at(current_day);
-                    created_schedule.end_at(created_schedule.start_at().value() + created_schedule.period() - days(1));
-                }
+void schedule_handler::process_due_events(schedule &current_schedule, const days &current_day,
+                                          const std::chrono::seconds &now) {
+    std::vector<schedule_action_handle> actions_to_execute;
+    // Timeline entry of every action in actions_to_execute, so failed actions can be mapped back to their event
+    std::vector<schedule_timeline::entry_index> action_entries;
+    auto logger_instance = logger::instance();
+
+    logger_instance->info("Checking events of schedule {}", current_schedule.title());
+
+    if (!current_schedule.start_at().has_value()) {
+        return;
+    }
+
+    auto day_in_schedule = current_day - current_schedule.start_at().value();
+    auto minutes_since_today = std::chrono::duration_cast<std::chrono::minutes>(now - current_day);
+    const auto &events = current_schedule.events();
+    auto &timeline = current_schedule.timeline();
+
+    // TODO: when the clock is set to an earlier timepoint this code won't behave correctly
+    auto due_entries = timeline.take_due_entries(day_in_schedule, minutes_since_today);
 
-                logger_instance->info("Added Schedule {} to the list of active schedules", created_schedule.title());
-                handler_instance->m_active_schedules.emplace_back(std::move(created_schedule));
+    for (auto current_entry_index : due_entries) {
+        const auto &current_entry = timeline.at(current_entry_index);
+        const auto &current_event = events[current_entry.m_event_index];
+
+        logger_instance->info("Scheduling actions of : {} id : {} for execution", current_event.name(),
+                              current_event.id().as_number());
+
+        auto [actions_begin, actions_end] = timeline.actions_of(current_entry);
+        for (auto current_action_id = actions_begin; current_action_id != actions_end; ++current_action_id) {
+            actions_to_execute.emplace_back(*current_action_id);
+            action_entries.emplace_back(current_entry_index);
+        }
+
+        current_event.mark_as_processed();
+    }
+
+    if (actions_to_execute.empty()) {
+        return;
+    }
+
+    // Actions are in order, because the events are in order (sorted by event time on a per day basis). The schedule
+    // is looked up again by its title, when the actions are done, the list of active schedules may have changed by then
+    schedule_action::execute_actions(
+        actions_to_execute, [schedule_title = current_schedule.title(), action_entries = std::move(action_entries)](
+                                std::vector<size_t> failed_actions) {
+            if (failed_actions.empty()) {
+                return;
             }
 
-            if (activate_schedules != handler_instance->m_inactive_schedules.cend()) {
-                handler_instance->m_inactive_schedules.erase(activate_schedules);
+            if (auto handler_instance = instance(); handler_instance != nullptr) {
+                handler_instance->handle_failed_actions(schedule_title, action_entries, failed_actions);
             }
+        });
+}
 
-            auto to_be_removed = std::remove_if(
-                handler_instance->m_active_schedules.begin(), handler_instance->m_active_schedules.end(),
-                [current_day](const auto &current_schedule) { return current_schedule.end_at() < current_day; });
+void schedule_handler::handle_failed_actions(const std::string &schedule_title,
+                                             const std::vector<schedule_timeline::entry_index> &action_entries,
+                                             const std::vector<size_t> &failed_actions) {
+    auto logger_instance = logger::instance();
 
-            if (to_be_removed != handler_instance->m_active_schedules.cend()) {
-                for (auto current_schedule = to_be_removed;
-                     current_schedule != handler_instance->m_active_schedules.cend(); ++current_schedule) {
-                    logger_instance->info("Remove schedule {} from the list of active schedules",
-                                          current_schedule->title());
-                    handler_instance->m_inactive_schedules.emplace_back(std::move(*current_schedule));
-                }
-                handler_instance->m_active_schedules.erase(to_be_removed);
+    {
+        auto lock = singleton<schedule_handler>::retrieve_instance_lock();
+
+        auto failed_schedule = std::find_if(
+            m_active_schedules.begin(), m_active_schedules.end(),
+            [&schedule_title](const auto &current_schedule) { return current_schedule.title() == schedule_title; });
+
+        if (failed_schedule == m_active_schedules.end()) {
+            logger_instance->warn("Schedule {} isn't active anymore, failed actions won't be retried", schedule_title);
+            return;
+        }
+
+        const auto &events = failed_schedule->events();
+        auto &timeline = failed_schedule->timeline();
+
+        logger_instance->warn("Some actions couldn't be executed");
+        auto retry_at = duration_since_epoch<std::chrono::seconds>() + _retry_interval;
+        // The failed positions are sorted and the actions of an event are next to each other, so every failed event is
+        // only visited once
+        std::optional<schedule_timeline::entry_index> last_failed_entry;
+        for (auto current_failed_position : failed_actions) {
+            auto failed_entry = action_entries[current_failed_position];
+
+            if (last_failed_entry == failed_entry) {
+                continue;
             }
+
+            last_failed_entry = failed_entry;
+            const auto &current_event = events[timeline.at(failed_entry).m_event_index];
+
+            // Some actions or all the actions of this event were unsuccesfull unmark as processed, so
+            // the are actions can be tried again
+            current_event.unmark_as_processed();
+            timeline.retry(failed_entry, retry_at);
+            logger_instance->critical("One or more actions of the event {} resulted in errors", current_event.name());
         }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        logger_instance->critical("Failed to execute some actions of schedule {}", schedule_title);
+
+        // Retry after the retry interval at the latest, an earlier deadline of the schedule takes the retries with it
+        auto schedule_index = static_cast<size_t>(std::distance(m_active_schedules.begin(), failed_schedule));
+        const auto &current_deadline = m_current_deadlines[schedule_index];
+
+        if (current_deadline.has_value() && *current_deadline <= retry_at) {
+            return;
+        }
+
+        push_deadline(schedule_index, retry_at);
     }
+
+    m_deadlines_changed.store(true);
+    wake_up_event_handler();
+}
+
+void schedule_handler::update_active_schedules(const days &current_day) {
+    auto logger_instance = logger::instance();
+
+    auto to_be_removed = std::stable_partition(
+        m_active_schedules.begin(), m_active_schedules.end(),
+        [current_day](const auto &current_schedule) { return current_schedule.end_at() >= current_day; });
+
+    for (auto current_schedule = to_be_removed; current_schedule != m_active_schedules.end(); ++current_schedule) {
+        logger_instance->info("Remove schedule {} from the list of active schedules", current_schedule->title());
+        m_inactive_schedules.emplace_back(std::move(*current_schedule));
+    }
+
+    m_active_schedules.erase(to_be_removed, m_active_schedules.end());
+
+    auto activate_schedules =
+        std::stable_partition(m_inactive_schedules.begin(), m_inactive_schedules.end(),
+                              [&current_day](const auto &current_schedule) {
+                                  return !(current_schedule.schedule_mode() == schedule::mode::repeating ||
+                                           current_schedule.end_at() >= current_day);
+                              });
+
+    for (auto current_schedule = activate_schedules; current_schedule != m_inactive_schedules.end();
+         ++current_schedule) {
+        auto created_schedule(*current_schedule);
+
+        for (const auto &current_event : created_schedule.events()) {
+            current_event.unmark_as_processed();
+        }
+        created_schedule.timeline().reset();
+
+        if (current_schedule->end_at() < current_day && created_schedule.schedule_mode() == schedule::mode::repeating) {
+            created_schedule.start_at(current_day);
+            created_schedule.end_at(created_schedule.start_at().value() + created_schedule.period() - days(1));
+        }
+
+        logger_instance->info("Added Schedule {} to the list of active schedules", created_schedule.title());
+        m_active_schedules.emplace_back(std::move(created_schedule));
+    }
+
+    m_inactive_schedules.erase(activate_schedules, m_inactive_schedules.end());
+}
+
+void schedule_handler::rebuild_deadlines() {
+    m_deadlines = decltype(m_deadlines){};
+    m_current_deadlines.assign(m_active_schedules.size(), std::nullopt);
+
+    for (size_t i = 0; i < m_active_schedules.size(); ++i) {
+        if (auto next_trigger_at = next_trigger_time(m_active_schedules[i]); next_trigger_at.has_value()) {
+            push_deadline(i, *next_trigger_at);
+        }
+    }
+}
+
+// Replaces the deadline of the schedule, the previous entry stays in the heap until it is popped
+void schedule_handler::push_deadline(size_t schedule_index, std::chrono::seconds trigger_at) {
+    m_current_deadlines[schedule_index] = trigger_at;
+    m_deadlines.push(schedule_deadline{trigger_at, schedule_index});
 }
 
 bool schedule_handler::is_conflicting_with_other_schedules(const schedule &sched) {
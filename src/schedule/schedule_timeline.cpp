@@ -0,0 +1,118 @@
+#include "schedule/schedule_timeline.h"
+
+#include <algorithm>
+
+#include "schedule/schedule_event.h"
+
+schedule_timeline schedule_timeline::compile(const std::vector<schedule_event> &events) {
+    schedule_timeline timeline;
+
+    timeline.m_entries.reserve(events.size());
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto &current_event = events[i];
+        auto actions_begin = static_cast<uint32_t>(timeline.m_actions.size());
+
+        for (const auto &current_action_id : current_event.actions()) {
+            if (auto handle = schedule_action::find_handle(current_action_id); handle.has_value()) {
+                timeline.m_actions.emplace_back(*handle);
+            }
+        }
+
+        timeline.m_entries.emplace_back(entry{current_event.day(), current_event.trigger_time(),
+                                              static_cast<entry_index>(i), actions_begin,
+                                              static_cast<uint32_t>(timeline.m_actions.size())});
+    }
+
+    // The events of a schedule should already be sorted, but the binary search depends on it
+    std::stable_sort(timeline.m_entries.begin(), timeline.m_entries.end(), [](const auto &lhs, const auto &rhs) {
+        return std::make_pair(lhs.m_day, lhs.m_trigger_time) < std::make_pair(rhs.m_day, rhs.m_trigger_time);
+    });
+
+    return timeline;
+}
+
+// Returns the entries which have to be retried and all the entries between the cursor and the provided time, the
+// cursor is advanced past the returned entries
+auto schedule_timeline::take_due_entries(const days &day_in_schedule, const std::chrono::minutes &time_of_day)
+    -> std::vector<entry_index> {
+    std::vector<entry_index> due_entries;
+    due_entries.reserve(m_retries.size());
+
+    for (const auto &current_retry : m_retries) {
+        due_entries.emplace_back(current_retry.m_index);
+    }
+
+    m_retries.clear();
+
+    auto due_end = std::upper_bound(m_entries.cbegin() + m_cursor, m_entries.cend(),
+                                    std::make_pair(day_in_schedule, time_of_day),
+                                    [](const auto &point_in_time, const auto &current_entry) {
+                                        return point_in_time < std::make_pair(current_entry.m_day,
+                                                                              current_entry.m_trigger_time);
+                                    });
+
+    auto new_cursor = static_cast<entry_index>(std::distance(m_entries.cbegin(), due_end));
+
+    for (auto i = m_cursor; i < new_cursor; ++i) {
+        due_entries.emplace_back(i);
+    }
+
+    m_cursor = new_cursor;
+
+    return due_entries;
+}
+
+// An entry, which is already waiting for a retry, keeps the earlier retry time
+void schedule_timeline::retry(entry_index index, std::chrono::seconds retry_at) {
+    if (index >= m_cursor) {
+        return;
+    }
+
+    auto position =
+        std::lower_bound(m_retries.begin(), m_retries.end(), index,
+                         [](const auto &current_retry, auto value) { return current_retry.m_index < value; });
+
+    if (position != m_retries.end() && position->m_index == index) {
+        position->m_retry_at = std::min(position->m_retry_at, retry_at);
+        return;
+    }
+
+    m_retries.insert(position, pending_retry{index, retry_at});
+}
+
+void schedule_timeline::reset() {
+    m_retries.clear();
+    m_cursor = 0;
+}
+
+auto schedule_timeline::next_trigger_time() const -> std::optional<std::pair<days, std::chrono::minutes>> {
+    if (m_cursor >= m_entries.size()) {
+        return {};
+    }
+
+    return std::make_pair(m_entries[m_cursor].m_day, m_entries[m_cursor].m_trigger_time);
+}
+
+std::optional<std::chrono::seconds> schedule_timeline::next_retry_time() const {
+    auto earliest_retry =
+        std::min_element(m_retries.cbegin(), m_retries.cend(), [](const auto &lhs, const auto &rhs) {
+            return lhs.m_retry_at < rhs.m_retry_at;
+        });
+
+    if (earliest_retry == m_retries.cend()) {
+        return {};
+    }
+
+    return earliest_retry->m_retry_at;
+}
+
+auto schedule_timeline::at(entry_index index) const -> const entry & { return m_entries[index]; }
+
+auto schedule_timeline::actions_of(const entry &timeline_entry) const
+    -> std::pair<action_iterator, action_iterator> {
+    return std::make_pair(m_actions.cbegin() + timeline_entry.m_actions_begin,
+                          m_actions.cbegin() + timeline_entry.m_actions_end);
+}
+
+size_t schedule_timeline::size() const { return m_entries.size(); }
@@ -0,0 +1,175 @@
+#define CATCH_CONFIG_MAIN
+#include "io/outputs/can/can_output.h"
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <optional>
+#include <string>
+
+#include "catch2/catch.hpp"
+
+// These tests need the virtual can device vcan0, which is created with
+// ip link add dev vcan0 type vcan && ip link set up vcan0
+namespace {
+constexpr char test_can_device[] = "vcan0";
+constexpr unsigned int transmit_identifier = 0x7E0;
+constexpr unsigned int flow_control_identifier = 0x7E8;
+
+// Socket of the node, which receives the values of the output
+int open_node_socket() {
+    int node_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    if (node_socket == -1) {
+        return -1;
+    }
+
+    ifreq interface_request{};
+    std::strncpy(interface_request.ifr_name, test_can_device, IFNAMSIZ - 1);
+
+    if (ioctl(node_socket, SIOCGIFINDEX, &interface_request) == -1) {
+        close(node_socket);
+        return -1;
+    }
+
+    sockaddr_can address{};
+    address.can_family = AF_CAN;
+    address.can_ifindex = interface_request.ifr_ifindex;
+
+    timeval receive_timeout{1, 0};
+    setsockopt(node_socket, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout, sizeof(receive_timeout));
+
+    if (bind(node_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1) {
+        close(node_socket);
+        return -1;
+    }
+
+    return node_socket;
+}
+
+std::optional<can_frame> receive_frame(int node_socket, unsigned int identifier = transmit_identifier) {
+    can_frame frame{};
+
+    while (read(node_socket, &frame, sizeof(frame)) == sizeof(frame)) {
+        if ((frame.can_id & CAN_EFF_MASK) == identifier) {
+            return frame;
+        }
+    }
+
+    return {};
+}
+}  // namespace
+
+TEST_CASE("Strings are sent through the transport of the can output") {
+    int node_socket = open_node_socket();
+
+    REQUIRE(node_socket != -1);
+
+    auto output = can_output::create_for_interface(nlohmann::json{{"can_device", test_can_device},
+                                                                  {"object_identifier", transmit_identifier},
+                                                                  {"flow_control_identifier", flow_control_identifier},
+                                                                  {"default", 0u},
+                                                                  {"transition", nullptr}});
+
+    REQUIRE(output != nullptr);
+
+    const std::string sent_string = "A string, which needs more than one frame";
+    // The control only returns after the transfer is finished, so the test answers as the node in the meantime
+    auto control_result = std::async(std::launch::async, [&output, &sent_string]() {
+        return output->control_output(output_value(sent_string));
+    });
+
+    // The output might still send its previous value, before the new value is transitioned to
+    std::optional<can_frame> first_frame;
+    for (auto frame = receive_frame(node_socket); frame.has_value(); frame = receive_frame(node_socket)) {
+        if ((frame->data[0] & 0xF0) == 0x10) {
+            first_frame = frame;
+            break;
+        }
+    }
+
+    REQUIRE(first_frame.has_value());
+    REQUIRE(first_frame->data[1] == sent_string.size());
+
+    std::string received_string(reinterpret_cast<const char *>(first_frame->data + 2), 6);
+
+    can_frame flow_control_frame{};
+    flow_control_frame.can_id = flow_control_identifier;
+    flow_control_frame.can_dlc = 3;
+    flow_control_frame.data[0] = 0x30;
+
+    REQUIRE(write(node_socket, &flow_control_frame, sizeof(flow_control_frame)) == sizeof(flow_control_frame));
+
+    while (received_string.size() < sent_string.size()) {
+        auto consecutive_frame = receive_frame(node_socket);
+
+        REQUIRE(consecutive_frame.has_value());
+        REQUIRE((consecutive_frame->data[0] & 0xF0) == 0x20);
+
+        received_string.append(reinterpret_cast<const char *>(consecutive_frame->data + 1),
+                               consecutive_frame->can_dlc - 1);
+    }
+
+    REQUIRE(received_string == sent_string);
+    REQUIRE(control_result.get());
+
+    close(node_socket);
+}
+
+TEST_CASE("Strings, which the node doesn't receive, are reported as failed controls") {
+    auto output = can_output::create_for_interface(nlohmann::json{{"can_device", test_can_device},
+                                                                  {"object_identifier", transmit_identifier},
+                                                                  {"flow_control_identifier", flow_control_identifier},
+                                                                  {"default", 0u},
+                                                                  {"transition", nullptr}});
+
+    REQUIRE(output != nullptr);
+
+    // Nobody answers the first frame with a flow control frame
+    REQUIRE(!output->control_output(output_value(std::string("A string, which needs more than one frame"))));
+}
+
+TEST_CASE("Batches send the controlled values at once") {
+    int node_socket = open_node_socket();
+
+    REQUIRE(node_socket != -1);
+
+    auto create_output = [](unsigned int identifier) {
+        return can_output::create_for_interface(nlohmann::json{{"can_device", test_can_device},
+                                                               {"object_identifier", identifier},
+                                                               {"default", 0u},
+                                                               {"transition", nullptr}});
+    };
+
+    auto first_output = create_output(0x100);
+    auto second_output = create_output(0x101);
+
+    REQUIRE(first_output != nullptr);
+    REQUIRE(second_output != nullptr);
+
+    auto results = first_output->control_outputs(
+        {{first_output.get(), output_value(7u)}, {second_output.get(), output_value(9u)}});
+
+    REQUIRE(results == std::vector<bool>{true, true});
+
+    // The frames carry the new values, not the values before the batch
+    auto first_frame = receive_frame(node_socket, 0x100);
+    auto second_frame = receive_frame(node_socket, 0x101);
+
+    REQUIRE(first_frame.has_value());
+    REQUIRE(second_frame.has_value());
+    REQUIRE(first_frame->data[0] == 7);
+    REQUIRE(second_frame->data[0] == 9);
+
+    // The values aren't sent again one frame at a time
+    REQUIRE(!receive_frame(node_socket, 0x100).has_value());
+
+    close(node_socket);
+}
@@ -0,0 +1,100 @@
+#define CATCH_CONFIG_MAIN
+#include "io/interfaces/gpio/gpio_input.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+namespace {
+using namespace std::chrono_literals;
+
+// Collects the events of an input, they are reported by the thread of the io_event_loop
+struct event_recorder {
+    void record(const input_event &event) {
+        std::lock_guard<std::mutex> events_guard{m_events_mutex};
+        m_events.push_back(event);
+        m_events_changed.notify_all();
+    }
+
+    std::vector<input_event> wait_for(size_t number_of_events, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> events_guard{m_events_mutex};
+        m_events_changed.wait_for(events_guard, timeout,
+                                  [this, number_of_events]() { return m_events.size() >= number_of_events; });
+        return m_events;
+    }
+
+    std::vector<input_event> m_events;
+    std::mutex m_events_mutex;
+    std::condition_variable m_events_changed;
+};
+
+timespec kernel_time(std::chrono::milliseconds time) {
+    return timespec{static_cast<time_t>(time.count() / 1000), static_cast<long>((time.count() % 1000) * 1000000)};
+}
+
+bool inject_edge(unsigned int pin, bool is_rising, std::chrono::milliseconds time) {
+    return gpiod::gpiod_line::inject_event(
+        pin, is_rising ? GPIOD_LINE_EVENT_RISING_EDGE : GPIOD_LINE_EVENT_FALLING_EDGE, kernel_time(time));
+}
+}  // namespace
+
+TEST_CASE("Edges without debouncing") {
+    auto input = gpio_input::create_for_interface({{"pin", 2u}, {"debounce", "0ms"}});
+    REQUIRE(input != nullptr);
+
+    event_recorder recorder;
+    input->on_event([&recorder](const auto &event) { recorder.record(event); });
+
+    REQUIRE(inject_edge(2, true, 1000ms));
+    auto events = recorder.wait_for(1, 1s);
+
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].m_value == output_value(switch_output::on));
+    REQUIRE(events[0].m_timestamp == 1000ms);
+    REQUIRE(input->read_value() == output_value(switch_output::on));
+
+    REQUIRE(inject_edge(2, false, 1500ms));
+    events = recorder.wait_for(2, 1s);
+
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[1].m_value == output_value(switch_output::off));
+    REQUIRE(input->read_value() == output_value(switch_output::off));
+}
+
+TEST_CASE("Bouncing edges are only reported once") {
+    auto input = gpio_input::create_for_interface({{"pin", 3u}, {"debounce", "30ms"}});
+    REQUIRE(input != nullptr);
+
+    event_recorder recorder;
+    input->on_event([&recorder](const auto &event) { recorder.record(event); });
+
+    REQUIRE(inject_edge(3, true, 2000ms));
+    REQUIRE(inject_edge(3, false, 2001ms));
+    REQUIRE(inject_edge(3, true, 2002ms));
+
+    auto events = recorder.wait_for(1, 1s);
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].m_value == output_value(switch_output::on));
+    REQUIRE(events[0].m_timestamp == 2002ms);
+
+    // A bounce, which ends at the old level, isn't reported at all
+    REQUIRE(inject_edge(3, false, 3000ms));
+    REQUIRE(inject_edge(3, true, 3001ms));
+
+    std::this_thread::sleep_for(100ms);
+    REQUIRE(recorder.wait_for(2, 0ms).size() == 1);
+    REQUIRE(input->read_value() == output_value(switch_output::on));
+}
+
+TEST_CASE("Events of removed inputs aren't read anymore") {
+    auto input = gpio_input::create_for_interface(nlohmann::json{{"pin", 4u}});
+    REQUIRE(input != nullptr);
+
+    input.reset();
+
+    REQUIRE_FALSE(inject_edge(4, true, 0ms));
+}
@@ -0,0 +1,68 @@
+#define CATCH_CONFIG_MAIN
+#include "io/interfaces/gpio/gpio_pin.h"
+
+#include "catch2/catch.hpp"
+
+TEST_CASE("Output pins of one chip are switched together") {
+    auto first_pin = gpio_pin::create_for_interface(nlohmann::json{{"pin", 5u}, {"default", "off"}});
+    auto second_pin = gpio_pin::create_for_interface(nlohmann::json{{"pin", 6u}, {"default", "off"}});
+
+    REQUIRE(first_pin != nullptr);
+    REQUIRE(second_pin != nullptr);
+    REQUIRE(first_pin->batch_driver() == second_pin->batch_driver());
+
+    // A line can only be requested once, the pins, which are already requested, keep working
+    REQUIRE(gpio_pin::create_for_interface(nlohmann::json{{"pin", 5u}, {"default", "off"}}) == nullptr);
+    REQUIRE(first_pin->control_output(switch_output::off));
+    REQUIRE(second_pin->control_output(switch_output::on));
+
+    auto results = first_pin->control_outputs(
+        {{first_pin.get(), output_value(switch_output::on)}, {second_pin.get(), output_value(switch_output::off)}});
+
+    REQUIRE(results == std::vector<bool>{true, true});
+
+    // The batch merged the requests of both lines, releasing one of them doesn't disturb the other one
+    second_pin.reset();
+
+    REQUIRE(first_pin->control_output(switch_output::toggle));
+    REQUIRE(first_pin->current_state() == output_value(switch_output::toggle));
+
+    // The released line can be requested again
+    second_pin = gpio_pin::create_for_interface(nlohmann::json{{"pin", 6u}, {"default", "off"}});
+
+    REQUIRE(second_pin != nullptr);
+    REQUIRE(second_pin->control_output(switch_output::on));
+}
+
+TEST_CASE("Failed line requests keep the other lines working") {
+    auto first_pin = gpio_pin::create_for_interface(nlohmann::json{{"pin", 10u}, {"default", "off"}});
+    auto second_pin = gpio_pin::create_for_interface(nlohmann::json{{"pin", 11u}, {"default", "off"}});
+
+    REQUIRE(first_pin != nullptr);
+    REQUIRE(second_pin != nullptr);
+
+    gpiod::gpiod_line_bulk::fail_next_requests(1);
+
+    REQUIRE(gpio_pin::create_for_interface(nlohmann::json{{"pin", 12u}, {"default", "off"}}) == nullptr);
+    REQUIRE(first_pin->control_output(switch_output::on));
+    REQUIRE(second_pin->control_output(switch_output::on));
+
+    // The line, which couldn't be requested, can be requested later
+    auto third_pin = gpio_pin::create_for_interface(nlohmann::json{{"pin", 12u}, {"default", "off"}});
+
+    REQUIRE(third_pin != nullptr);
+
+    // If the lines can't be requested together, they are requested like before and written one request at a time
+    gpiod::gpiod_line_bulk::fail_next_requests(1);
+
+    auto results = first_pin->control_outputs(
+        {{first_pin.get(), output_value(switch_output::off)}, {second_pin.get(), output_value(switch_output::off)}});
+
+    REQUIRE(results == std::vector<bool>{true, true});
+    REQUIRE(first_pin->control_output(switch_output::on));
+    REQUIRE(second_pin->control_output(switch_output::on));
+    REQUIRE(third_pin->control_output(switch_output::on));
+
+    // The failed request was the one of the merged lines, so the next request succeeds
+    REQUIRE(gpio_pin::create_for_interface(nlohmann::json{{"pin", 13u}, {"default", "off"}}) != nullptr);
+}
@@ -0,0 +1,125 @@
+#define CATCH_CONFIG_MAIN
+#include "io/interfaces/can/isotp_transfer.h"
+
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+static can_message flow_control_frame(uint8_t flow_status, uint8_t block_size, uint8_t separation_time) {
+    can_message message{can_object_identifier(0x7E8), 3};
+    message.m_data[0] = 0x30 | flow_status;
+    message.m_data[1] = block_size;
+    message.m_data[2] = separation_time;
+
+    return message;
+}
+
+static std::vector<uint8_t> payload_of_size(size_t size) {
+    std::vector<uint8_t> payload(size);
+    std::iota(payload.begin(), payload.end(), 0);
+
+    return payload;
+}
+
+TEST_CASE("Short payloads are sent in a single frame") {
+    isotp_transfer transfer(can_object_identifier(0x7E0), {0xAA, 0xBB, 0xCC});
+
+    auto frame = transfer.start();
+
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::finished);
+    REQUIRE(frame.m_identifier == can_object_identifier(0x7E0));
+    REQUIRE(frame.m_length == 4);
+    REQUIRE(frame.m_data[0] == 0x03);
+    REQUIRE(frame.m_data[1] == 0xAA);
+    REQUIRE(frame.m_data[3] == 0xCC);
+    REQUIRE(transfer.next_frames().empty());
+}
+
+TEST_CASE("Long payloads are segmented after the flow control") {
+    auto payload = payload_of_size(20);
+    isotp_transfer transfer(can_object_identifier(0x7E0), payload);
+
+    auto first_frame = transfer.start();
+
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::waiting_for_flow_control);
+    REQUIRE(first_frame.m_length == 8);
+    REQUIRE(first_frame.m_data[0] == 0x10);
+    REQUIRE(first_frame.m_data[1] == 20);
+    REQUIRE(first_frame.m_data[2] == 0);
+    REQUIRE(first_frame.m_data[7] == 5);
+
+    // Nothing is sent without a flow control frame
+    REQUIRE(transfer.next_frames().empty());
+
+    transfer.handle_flow_control(flow_control_frame(0x0, 0, 0));
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::sending);
+
+    // Without a block size and separation time the rest of the payload is sent at once
+    auto frames = transfer.next_frames();
+
+    REQUIRE(frames.size() == 2);
+    REQUIRE(frames[0].m_data[0] == 0x21);
+    REQUIRE(frames[0].m_data[1] == 6);
+    REQUIRE(frames[0].m_length == 8);
+    REQUIRE(frames[1].m_data[0] == 0x22);
+    REQUIRE(frames[1].m_data[1] == 13);
+    REQUIRE(frames[1].m_length == 8);
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::finished);
+}
+
+TEST_CASE("Blocks and separation times of the receiver are respected") {
+    isotp_transfer transfer(can_object_identifier(0x7E0), payload_of_size(300));
+    transfer.start();
+
+    // Wait frames keep the transfer waiting
+    transfer.handle_flow_control(flow_control_frame(0x1, 0, 0));
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::waiting_for_flow_control);
+
+    transfer.handle_flow_control(flow_control_frame(0x0, 3, 0));
+    REQUIRE(transfer.next_frames().size() == 3);
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::waiting_for_flow_control);
+
+    transfer.handle_flow_control(flow_control_frame(0x0, 0, 0xF5));
+    REQUIRE(transfer.separation_time() == std::chrono::microseconds(500));
+
+    // With a separation time the frames are sent one by one, the sequence number wraps around after 15
+    uint8_t expected_sequence_number = 4;
+    size_t number_of_frames = 3;
+
+    while (transfer.state() == isotp_transfer::transfer_state::sending) {
+        auto frames = transfer.next_frames();
+
+        REQUIRE(frames.size() == 1);
+        REQUIRE((frames[0].m_data[0] & 0x0F) == expected_sequence_number);
+
+        expected_sequence_number = (expected_sequence_number + 1) & 0x0F;
+        ++number_of_frames;
+    }
+
+    REQUIRE(transfer.state() == isotp_transfer::transfer_state::finished);
+    // 6 bytes in the first frame, 7 bytes in every consecutive frame
+    REQUIRE(number_of_frames == 42);
+}
+
+TEST_CASE("Failed transfers") {
+    isotp_transfer overflowing_transfer(can_object_identifier(0x7E0), payload_of_size(100));
+    overflowing_transfer.start();
+    overflowing_transfer.handle_flow_control(flow_control_frame(0x2, 0, 0));
+
+    REQUIRE(overflowing_transfer.state() == isotp_transfer::transfer_state::failed);
+    REQUIRE(overflowing_transfer.next_frames().empty());
+
+    isotp_transfer aborted_transfer(can_object_identifier(0x7E0), payload_of_size(100));
+    aborted_transfer.start();
+    aborted_transfer.abort();
+
+    REQUIRE(aborted_transfer.state() == isotp_transfer::transfer_state::failed);
+
+    isotp_transfer too_large_transfer(can_object_identifier(0x7E0),
+                                      payload_of_size(isotp_transfer::max_payload_size + 1));
+    too_large_transfer.start();
+
+    REQUIRE(too_large_transfer.state() == isotp_transfer::transfer_state::failed);
+}
@@ -0,0 +1,128 @@
+#define CATCH_CONFIG_MAIN
+#include "io/outputs/output_change_bus.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "catch2/catch.hpp"
+
+TEST_CASE("Bounded queue") {
+    bounded_queue<int> queue(3);
+
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE_FALSE(queue.try_pop().has_value());
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.try_push(i));
+    }
+
+    REQUIRE_FALSE(queue.try_push(4));
+    REQUIRE(queue.size_approx() == 4);
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.try_pop() == i);
+    }
+
+    REQUIRE_FALSE(queue.try_pop().has_value());
+}
+
+TEST_CASE("Bounded queue with multiple producers") {
+    constexpr int number_of_producers = 4;
+    constexpr int values_per_producer = 20000;
+
+    bounded_queue<std::pair<int, int>> queue(64);
+    std::vector<std::thread> producers;
+
+    for (int producer = 0; producer < number_of_producers; ++producer) {
+        producers.emplace_back([&queue, producer]() {
+            for (int i = 0; i < values_per_producer; ++i) {
+                while (!queue.try_push(std::make_pair(producer, i))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // The values of one producer have to arrive in order
+    std::vector<int> next_values(number_of_producers, 0);
+    int received_values = 0;
+
+    while (received_values < number_of_producers * values_per_producer) {
+        auto value = queue.try_pop();
+
+        if (!value.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        REQUIRE(value->second == next_values[value->first]);
+        ++next_values[value->first];
+        ++received_values;
+    }
+
+    for (auto &current_producer : producers) {
+        current_producer.join();
+    }
+
+    REQUIRE_FALSE(queue.try_pop().has_value());
+}
+
+TEST_CASE("Output change bus") {
+    REQUIRE_FALSE(output_change_bus::has_subscribers());
+
+    auto first_subscription = output_change_bus::subscribe(2);
+    auto second_subscription = output_change_bus::subscribe();
+
+    REQUIRE(output_change_bus::has_subscribers());
+
+    output_change_bus::publish(output_handle{1}, output_value(10), output_change_source::control);
+    output_change_bus::publish(output_handle{2}, output_value(20), output_change_source::override);
+    output_change_bus::publish(output_handle{1}, output_value(30), output_change_source::transition);
+
+    // The first subscription is full, so the third change is dropped
+    REQUIRE(first_subscription->dropped_changes() == 1);
+    REQUIRE(second_subscription->dropped_changes() == 0);
+
+    auto change = second_subscription->try_pop();
+    REQUIRE(change.has_value());
+    REQUIRE(change->m_output == output_handle{1});
+    REQUIRE(change->m_value == output_value(10));
+    REQUIRE(change->m_source == output_change_source::control);
+
+    REQUIRE(second_subscription->try_pop()->m_source == output_change_source::override);
+    REQUIRE(second_subscription->try_pop()->m_value == output_value(30));
+    REQUIRE_FALSE(second_subscription->try_pop().has_value());
+
+    REQUIRE(first_subscription->try_pop()->m_value == output_value(10));
+    REQUIRE(first_subscription->try_pop()->m_value == output_value(20));
+
+    first_subscription.reset();
+    second_subscription.reset();
+
+    REQUIRE_FALSE(output_change_bus::has_subscribers());
+}
+
+TEST_CASE("Waiting subscribers are woken up") {
+    using namespace std::chrono_literals;
+
+    auto subscription = output_change_bus::subscribe();
+
+    REQUIRE_FALSE(subscription->wait_pop(10ms).has_value());
+
+    std::thread publisher([]() {
+        std::this_thread::sleep_for(50ms);
+        output_change_bus::publish(output_handle{3}, output_value(1), output_change_source::restore);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    auto change = subscription->wait_pop(5s);
+    auto waited = std::chrono::steady_clock::now() - start;
+
+    publisher.join();
+
+    REQUIRE(change.has_value());
+    REQUIRE(change->m_source == output_change_source::restore);
+    REQUIRE(waited < 1s);
+}
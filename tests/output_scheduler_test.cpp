@@ -0,0 +1,295 @@
+#define CATCH_CONFIG_MAIN
+#include "io/outputs/output_scheduler.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "run_configuration.h"
+#include "schedule/schedule.h"
+#include "schedule/schedule_action.h"
+
+namespace {
+// Every action controls two outputs, the second output of every third action fails
+batch_output_control_result create_result(size_t number_of_actions) {
+    std::vector<output_control_report> reports;
+    reports.reserve(number_of_actions * 2);
+
+    for (size_t i = 0; i < number_of_actions; ++i) {
+        auto handle = static_cast<output_handle>(i);
+        reports.push_back(output_control_report{{handle, output_value(0)}, output_control_result::success, i});
+        reports.push_back(output_control_report{
+            {handle, output_value(1)}, i % 3 == 0 ? output_control_result::failure : output_control_result::success, i});
+    }
+
+    return batch_output_control_result{.batch_result = true, .output_controls = {}, .control_results = reports};
+}
+
+// Records the values of all the outputs in the order they were written. The first write of the output "blocking"
+// waits until the test releases it, so its output stays busy in the meantime. The first write of the output
+// "unrelated" is signaled to the test
+class recording_output final : public output_interface {
+   public:
+    recording_output(std::string name, bool should_fail, bool shares_driver)
+        : m_name(std::move(name)), m_should_fail(should_fail), m_shares_driver(shares_driver) {}
+
+    static std::unique_ptr<output_interface> create_for_interface(const json &description) {
+        return std::make_unique<recording_output>(description.value("name", std::string{}),
+                                                  description.value("fails", false),
+                                                  description.value("shares_driver", false));
+    }
+
+    bool control_output(const output_value &value) override {
+        if (m_name == "blocking" && _blocking_output_started.has_value()) {
+            _blocking_output_started->set_value();
+            _blocking_output_started.reset();
+            _release_blocking_output.get_future().wait();
+        }
+
+        {
+            std::lock_guard<std::mutex> writes_guard{_writes_mutex};
+            _writes.emplace_back(m_name, value);
+            m_value = value;
+        }
+
+        if (m_name == "unrelated" && _unrelated_output_written.has_value()) {
+            _unrelated_output_written->set_value();
+            _unrelated_output_written.reset();
+        }
+
+        return !m_should_fail;
+    }
+
+    bool override_with(const output_value &value) override { return control_output(value); }
+    bool restore_control() override { return true; }
+    std::optional<output_value> is_overriden() const override { return {}; }
+    output_value current_state() const override { return m_value; }
+
+    // Outputs, which share the driver, are controlled in one task by the scheduler
+    const void *batch_driver() const override { return m_shares_driver ? static_cast<const void *>(&_writes) : this; }
+
+    static inline std::optional<std::promise<void>> _blocking_output_started;
+    static inline std::optional<std::promise<void>> _unrelated_output_written;
+    static inline std::promise<void> _release_blocking_output;
+    static inline std::vector<std::pair<std::string, output_value>> _writes;
+    static inline std::mutex _writes_mutex;
+
+   private:
+    const std::string m_name;
+    const bool m_should_fail;
+    const bool m_shares_driver;
+    output_value m_value{0};
+};
+
+json recording_output_description(const std::string &name, bool should_fail = false, bool shares_driver = false) {
+    return json{{"id", name},
+                {"type", "recording"},
+                {"description", {{"name", name}, {"fails", should_fail}, {"shares_driver", shares_driver}}},
+                {"suppress_writes", false}};
+}
+
+// Number of tasks, which were queued on any of the workers
+size_t number_of_dispatched_tasks() {
+    size_t dispatched_tasks = 0;
+
+    for (const auto &current_statistics : output_scheduler::queue_statistics()) {
+        dispatched_tasks +=
+            current_statistics.queue_depth + current_statistics.executed_tasks + current_statistics.cancelled_tasks;
+    }
+
+    return dispatched_tasks;
+}
+
+// Adds the outputs and actions with a schedule file, the config gives the recording outputs two workers
+void load_outputs_and_actions(const json &output_descriptions, const json &action_descriptions) {
+    auto test_directory = std::filesystem::temp_directory_path();
+    auto config_path = test_directory / "output_scheduler_test_config.json";
+    auto schedule_path = test_directory / "output_scheduler_test_schedule.json";
+
+    std::ofstream(config_path) << json{{"date_format", "%d.%m.%Y"}, {"output_workers", {{"recording", 2u}}}}.dump();
+    std::ofstream(schedule_path) << json{{"outputs", output_descriptions},
+                                         {"actions", action_descriptions},
+                                         {"schedule", {{"events", json::array()}}}}
+                                        .dump();
+
+    run_configuration::instance()->config_path(config_path.string());
+    output_factory::register_interface("recording", &recording_output::create_for_interface);
+    schedule::create_from_file(schedule_path);
+}
+}  // namespace
+
+TEST_CASE("Failure attribution") {
+    batch_output_control job;
+    job.add_output_controls({{output_handle{0}, output_value(0)}, {output_handle{1}, output_value(1)}}, 3);
+    job.add_output_control(batch_output_control::output_control_type{output_handle{2}, output_value(2)});
+
+    REQUIRE(job.origins().size() == 3);
+    REQUIRE(job.origins()[0] == 3);
+    REQUIRE(job.origins()[1] == 3);
+    REQUIRE(job.origins()[2] == batch_output_control::no_origin);
+
+    batch_output_control_result result{
+        .batch_result = false,
+        .output_controls = {},
+        .control_results = {{{output_handle{0}, output_value(0)}, output_control_result::failure, 3},
+                            {{output_handle{1}, output_value(1)}, output_control_result::failure, 3},
+                            {{output_handle{2}, output_value(2)}, output_control_result::skipped, 1},
+                            {{output_handle{3}, output_value(3)}, output_control_result::failure, 0},
+                            {{output_handle{5}, output_value(5)}, output_control_result::timed_out, 2},
+                            {{output_handle{4}, output_value(4)}, output_control_result::failure,
+                             batch_output_control::no_origin}}};
+
+    REQUIRE(result.failed_origins(4) == std::vector<size_t>{0, 2, 3});
+    REQUIRE(result.failed_origins(2) == std::vector<size_t>{0});
+}
+
+TEST_CASE("Failure attribution of large batches") {
+    auto result = create_result(16000);
+    auto failed = result.failed_origins(16000);
+
+    std::vector<size_t> expected_failures;
+    for (size_t i = 0; i < 16000; i += 3) {
+        expected_failures.emplace_back(i);
+    }
+
+    // Every failed origin is reported once and in order, even if several of its controls failed
+    REQUIRE(failed == expected_failures);
+
+    // Origins past the number of origins are ignored
+    REQUIRE(result.failed_origins(10) == std::vector<size_t>{0, 3, 6, 9});
+    REQUIRE(result.failed_origins(0).empty());
+}
+
+TEST_CASE("Batches with unknown outputs") {
+    auto dispatched_tasks_before = number_of_dispatched_tasks();
+
+    batch_output_control job;
+    job.add_output_controls({{output_handle{0}, output_value(0)}, {output_handle{0}, output_value(1)}}, 0);
+    job.optimize_outputs(true);
+
+    auto result_future = output_scheduler::execute_batch_output_control(job);
+
+    REQUIRE(result_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+
+    auto result = result_future.get();
+
+    REQUIRE(result.output_controls.empty());
+    REQUIRE(result.control_results.size() == 2);
+    REQUIRE(result.failed_origins(1) == std::vector<size_t>{0});
+
+    batch_output_control id_job;
+    id_job.add_output_control({"unknown_output", output_value(1)});
+
+    REQUIRE(id_job.number_of_occured_errors() == 1);
+
+    auto id_result_future = output_scheduler::execute_batch_output_control(id_job);
+
+    REQUIRE(id_result_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+
+    auto id_result = id_result_future.get();
+
+    REQUIRE(id_result.control_results.size() == 1);
+    REQUIRE(id_result.control_results[0].result == output_control_result::failure);
+
+    // Unknown outputs are never dispatched to a worker
+    REQUIRE(number_of_dispatched_tasks() == dispatched_tasks_before);
+}
+
+TEST_CASE("Tasks of one output keep their order with multiple workers") {
+    load_outputs_and_actions(json::array({recording_output_description("blocking", false, true),
+                                          recording_output_description("shared", false, true),
+                                          recording_output_description("unrelated")}),
+                             json::array());
+
+    auto blocking_output = outputs::find_handle("blocking");
+    auto shared_output = outputs::find_handle("shared");
+    auto unrelated_output = outputs::find_handle("unrelated");
+
+    REQUIRE(blocking_output.has_value());
+    REQUIRE(shared_output.has_value());
+    REQUIRE(unrelated_output.has_value());
+
+    auto started_future = recording_output::_blocking_output_started.emplace().get_future();
+    auto unrelated_written_future = recording_output::_unrelated_output_written.emplace().get_future();
+
+    // Keeps one worker busy with the blocking output
+    batch_output_control blocking_job;
+    blocking_job.add_output_controls({{*blocking_output, output_value(1)}});
+    auto blocking_result = output_scheduler::execute_batch_output_control(blocking_job);
+
+    REQUIRE(started_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+
+    // The task on {blocking, shared} has to wait, the task on {shared} mustn't overtake it on the idle worker
+    batch_output_control both_outputs_job;
+    both_outputs_job.add_output_controls({{*blocking_output, output_value(2)}, {*shared_output, output_value(2)}});
+    auto both_outputs_result = output_scheduler::execute_batch_output_control(both_outputs_job);
+
+    batch_output_control shared_output_job;
+    shared_output_job.add_output_controls({{*shared_output, output_value(3)}});
+    auto shared_output_result = output_scheduler::execute_batch_output_control(shared_output_job);
+
+    // The idle worker only gets to the task on {unrelated} after it skipped the task on {shared}
+    batch_output_control unrelated_output_job;
+    unrelated_output_job.add_output_controls({{*unrelated_output, output_value(4)}});
+    auto unrelated_output_result = output_scheduler::execute_batch_output_control(unrelated_output_job);
+
+    REQUIRE(unrelated_written_future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    recording_output::_release_blocking_output.set_value();
+
+    REQUIRE(blocking_result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(both_outputs_result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(shared_output_result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(unrelated_output_result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+
+    auto statistics = output_scheduler::queue_statistics();
+
+    REQUIRE(statistics.size() == 1);
+    REQUIRE(statistics[0].number_of_workers == 2);
+
+    std::lock_guard<std::mutex> writes_guard{recording_output::_writes_mutex};
+    std::vector<std::pair<std::string, output_value>> expected_writes{
+        {"unrelated", output_value(4)}, {"blocking", output_value(1)}, {"blocking", output_value(2)},
+        {"shared", output_value(2)},    {"shared", output_value(3)}};
+
+    REQUIRE(recording_output::_writes == expected_writes);
+}
+
+// Measures the whole path of failed actions: the controls are dispatched to the workers, executed and the failures
+// are attributed back to the actions. Run it with the [.benchmark] tag, it doesn't assert anything about the time
+TEST_CASE("Execution of large batches of actions", "[.benchmark]") {
+    constexpr size_t number_of_actions = 4000;
+
+    json output_descriptions = json::array();
+    json action_descriptions = json::array();
+
+    for (size_t i = 0; i < number_of_actions; ++i) {
+        auto name = "benchmark_" + std::to_string(i);
+        // Every third output fails, so every third action has to be retried
+        output_descriptions.push_back(recording_output_description(name, i % 3 == 0));
+        action_descriptions.push_back(json{{"id", name}, {"outputs", {name}}, {"output_actions", {"on"}}});
+    }
+
+    load_outputs_and_actions(output_descriptions, action_descriptions);
+
+    std::vector<schedule_action_handle> handles;
+    handles.reserve(number_of_actions);
+
+    for (size_t i = 0; i < number_of_actions; ++i) {
+        auto handle = schedule_action::find_handle("benchmark_" + std::to_string(i));
+        REQUIRE(handle.has_value());
+        handles.emplace_back(*handle);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto failed_actions = schedule_action::execute_actions(handles);
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    REQUIRE(failed_actions.size() == (number_of_actions + 2) / 3);
+    WARN("Executed " << number_of_actions << " actions in " << duration.count() << "us");
+}
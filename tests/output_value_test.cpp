@@ -2,9 +2,12 @@
 #include "io/outputs/output_value.h"
 
 #include <algorithm>
+#include <chrono>
 #include <string>
+#include <thread>
 
 #include "catch2/catch.hpp"
+#include "io/outputs/output_transition.h"
 
 TEST_CASE("Basic output_value tests") {
     using namespace std::literals;
@@ -30,3 +33,35 @@ TEST_CASE("Basic deserializing tests") {
     REQUIRE(created_value->current_type() == output_value_types::number);
     REQUIRE(created_value2->current_type() == output_value_types::number_unsigned);
 }
+
+TEST_CASE("Timed transitions") {
+    using namespace output_transitions;
+    using namespace std::literals;
+
+    REQUIRE(curve_progress(transition_curve::linear, 0.25) == Approx(0.25));
+    REQUIRE(curve_progress(transition_curve::ease_in_out, 0.5) == Approx(0.5));
+    REQUIRE(curve_progress(transition_curve::ease_in_out, 0.1) < 0.1);
+    REQUIRE(curve_progress(transition_curve::sunrise, 0.5) < 0.5);
+    REQUIRE(curve_progress(transition_curve::sunrise, 1.0) == Approx(1.0));
+    REQUIRE(curve_progress(transition_curve::linear, 2.0) == Approx(1.0));
+
+    REQUIRE(*interpolate(output_value(0u), output_value(100u), 0.5).get<unsigned int>() == 50);
+    REQUIRE(*interpolate(output_value(100), output_value(-100), 0.25).get<int>() == 50);
+    REQUIRE(*interpolate(output_value(0), output_value("on"s), 0.5).get<std::string>() == "on");
+
+    timed_transition<> transition(transition_curve::linear, std::chrono::milliseconds(200));
+    output_value current_value(0u);
+    output_value target_value(100u);
+
+    REQUIRE(transition(std::chrono::milliseconds(0), current_value, target_value) !=
+            transition_state::finished_transition);
+
+    auto halfway = transition.value_at(std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    REQUIRE(*halfway.get<unsigned int>() >= 45);
+    REQUIRE(*halfway.get<unsigned int>() <= 55);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    REQUIRE(transition(std::chrono::milliseconds(250), current_value, target_value) ==
+            transition_state::finished_transition);
+    REQUIRE(current_value == target_value);
+}
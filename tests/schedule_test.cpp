@@ -91,5 +91,60 @@ TEST_CASE("Basic schedule testing") {
         REQUIRE(events[3].name() == "light_off#2");
     }
 
+    SECTION("Schedule timeline") {
+        const std::filesystem::path testfiles[] = {"../tests/test_schedules/basic_test_schedule.json"};
+        json schedule_description3 = json::parse(std::ifstream(testfiles[0]));
+        schedule_description3["schedule"]["title"] = "aquarium#3";
+
+        auto sched = schedule::deserialize(schedule_description3["schedule"]);
+
+        REQUIRE(sched.has_value());
+
+        sched->compile_timeline();
+        auto &timeline = sched->timeline();
+        const auto &events = sched->events();
+
+        REQUIRE(timeline.size() == events.size());
+        REQUIRE(timeline.next_trigger_time().has_value());
+        REQUIRE(timeline.next_trigger_time()->first == events[0].day());
+        REQUIRE(timeline.next_trigger_time()->second == events[0].trigger_time());
+
+        REQUIRE(timeline.take_due_entries(days(0), events[0].trigger_time() - std::chrono::minutes(1)).empty());
+
+        auto due_entries = timeline.take_due_entries(days(0), events[0].trigger_time());
+
+        REQUIRE(due_entries.size() == 1);
+        REQUIRE(events[timeline.at(due_entries[0]).m_event_index].name() == events[0].name());
+
+        auto [actions_begin, actions_end] = timeline.actions_of(timeline.at(due_entries[0]));
+        auto is_handle_of_id = [](const auto &handle, const auto &id) {
+            return schedule_action::find_handle(id) == handle;
+        };
+        REQUIRE(std::equal(actions_begin, actions_end, events[0].actions().cbegin(), events[0].actions().cend(),
+                           is_handle_of_id));
+
+        REQUIRE(timeline.take_due_entries(days(0), events[0].trigger_time()).empty());
+
+        REQUIRE(!timeline.next_retry_time().has_value());
+
+        // Retries are due at their retry time, the earlier one is kept
+        timeline.retry(due_entries[0], std::chrono::seconds(200));
+        timeline.retry(due_entries[0], std::chrono::seconds(100));
+        timeline.retry(due_entries[0], std::chrono::seconds(300));
+        REQUIRE(timeline.next_retry_time() == std::chrono::seconds(100));
+        REQUIRE(timeline.next_trigger_time() == std::make_pair(timeline.at(1).m_day, timeline.at(1).m_trigger_time));
+        REQUIRE(timeline.take_due_entries(days(0), events[0].trigger_time()) == due_entries);
+        REQUIRE(!timeline.next_retry_time().has_value());
+
+        auto remaining_entries = timeline.take_due_entries(events.back().day() + days(1), std::chrono::minutes(0));
+
+        REQUIRE(remaining_entries.size() == events.size() - 1);
+        REQUIRE(!timeline.next_trigger_time().has_value());
+
+        timeline.reset();
+
+        REQUIRE(timeline.take_due_entries(events.back().day(), events.back().trigger_time()).size() == events.size());
+    }
+
     // TODO add more test cases
 }
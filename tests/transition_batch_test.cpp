@@ -0,0 +1,90 @@
+#define CATCH_CONFIG_MAIN
+#include "io/outputs/transition_batch.h"
+
+#include <chrono>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+namespace {
+using namespace output_transitions;
+
+transition_curve curve_of_channel(size_t channel) {
+    switch (channel % 3) {
+        case 0:
+            return transition_curve::linear;
+        case 1:
+            return transition_curve::ease_in_out;
+        default:
+            return transition_curve::sunrise;
+    }
+}
+
+// Evaluates the same transitions once with one timed_transition per channel and once with a transition_batch
+void compare_with_transitioners(size_t number_of_channels) {
+    const std::chrono::milliseconds duration(10000);
+
+    std::vector<timed_transition<>> transitions;
+    std::vector<output_value> current_values;
+    std::vector<output_value> target_values;
+    transition_batch batch;
+
+    transitions.reserve(number_of_channels);
+
+    for (size_t i = 0; i < number_of_channels; ++i) {
+        auto target = static_cast<unsigned int>(1000 + i);
+        transitions.emplace_back(curve_of_channel(i), duration);
+        current_values.emplace_back(0u);
+        target_values.emplace_back(target);
+
+        // Starts the transition
+        transitions[i](std::chrono::milliseconds(0), current_values[i], target_values[i]);
+        batch.add(0.0, static_cast<double>(target), std::chrono::steady_clock::now(), duration, curve_of_channel(i));
+    }
+
+    auto evaluate_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(2500);
+
+    for (size_t i = 0; i < number_of_channels; ++i) {
+        current_values[i] = transitions[i].value_at(evaluate_at);
+    }
+
+    batch.evaluate(evaluate_at);
+
+    // The start times differ slightly, so the values may differ by one step
+    for (size_t i = 0; i < number_of_channels; ++i) {
+        double expected = static_cast<double>(*current_values[i].get<unsigned int>());
+        REQUIRE(batch.values()[i] == Approx(expected).margin(2.0));
+    }
+}
+}  // namespace
+
+TEST_CASE("transition_batch basic test") {
+    transition_batch batch;
+    auto now = std::chrono::steady_clock::now();
+
+    auto first = batch.add(0.0, 100.0, now, std::chrono::milliseconds(1000), transition_curve::linear);
+    auto second = batch.add(100.0, 0.0, now, std::chrono::milliseconds(2000), transition_curve::ease_in_out);
+    batch.add(0.0, 50.0, now, std::chrono::milliseconds(0), transition_curve::sunrise);
+
+    batch.evaluate(now + std::chrono::milliseconds(500));
+
+    REQUIRE(batch.values()[first] == Approx(50.0));
+    REQUIRE(batch.values()[second] == Approx(84.375));
+    REQUIRE(batch.values()[2] == Approx(50.0));
+    REQUIRE(!batch.is_finished(first));
+    REQUIRE(batch.is_finished(2));
+
+    batch.remove(first);
+    REQUIRE(batch.size() == 2);
+
+    batch.evaluate(now + std::chrono::milliseconds(2000));
+    REQUIRE(batch.values()[0] == Approx(50.0));
+    REQUIRE(batch.values()[second] == Approx(0.0));
+    REQUIRE(batch.is_finished(second));
+}
+
+TEST_CASE("transition_batch compared to single transitions") {
+    compare_with_transitioners(10);
+    compare_with_transitioners(100);
+    compare_with_transitioners(1000);
+}
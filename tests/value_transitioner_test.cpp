@@ -1,10 +1,46 @@
 #define CATCH_CONFIG_MAIN
 #include "value_transitioner.h"
 
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <vector>
 
 #include "catch2/catch.hpp"
 
+namespace {
+// Reaches the target value one second after the target value has changed, the steps only restart the transition
+struct evaluable_transition {
+    using clock_type = transition_engine::clock_type;
+
+    transition_state operator()(std::chrono::milliseconds, int &current_value, const int &target_value) const {
+        if (!m_target_value.has_value() || *m_target_value != target_value) {
+            m_start_value = current_value;
+            m_target_value = target_value;
+            m_start_time = clock_type::now();
+        }
+
+        current_value = value_at(clock_type::now());
+        return current_value == target_value ? transition_state::finished_transition
+                                             : transition_state::value_did_change;
+    }
+
+    int value_at(clock_type::time_point point_in_time) const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(point_in_time - m_start_time);
+
+        if (!m_target_value.has_value() || elapsed >= std::chrono::seconds(1)) {
+            return m_target_value.value_or(0);
+        }
+
+        return m_start_value + (*m_target_value - m_start_value) * elapsed.count() / 1000;
+    }
+
+    mutable int m_start_value = 0;
+    mutable std::optional<int> m_target_value;
+    mutable clock_type::time_point m_start_time;
+};
+}  // namespace
+
 TEST_CASE("value_transitioner basic test") {
     int value = 0;
     int index = 0;
@@ -44,3 +80,101 @@ TEST_CASE("value_transitioner basic test") {
     REQUIRE(value == target);
     REQUIRE(index > 10);
 }
+
+TEST_CASE("value_transitioner is only active during a transition") {
+    value_transitioner<int> transitioner(0);
+    auto engine = transition_engine::instance();
+
+    transitioner.start_transition_thread(
+        [](auto time_diff, auto &current_value, const auto &target_value) {
+            if (current_value == target_value) {
+                return transition_state::finished_transition;
+            }
+
+            current_value += current_value < target_value ? 1 : -1;
+            return transition_state::value_did_change;
+        },
+        std::chrono::milliseconds(10));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(engine->number_of_active_transitions() == 0);
+
+    transitioner.target_value(5);
+    REQUIRE(engine->number_of_active_transitions() == 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    REQUIRE(transitioner.current_value() == 5);
+    REQUIRE(engine->number_of_active_transitions() == 0);
+}
+
+TEST_CASE("value_transitioner can be moved during a transition") {
+    std::vector<value_transitioner<int>> transitioners;
+    transitioners.emplace_back(0);
+
+    transitioners[0].start_transition_thread(
+        [](auto time_diff, auto &current_value, const auto &target_value) {
+            if (current_value == target_value) {
+                return transition_state::finished_transition;
+            }
+
+            current_value += current_value < target_value ? 1 : -1;
+            return transition_state::value_did_change;
+        },
+        std::chrono::milliseconds(10));
+    transitioners[0].target_value(20);
+
+    // Reallocates the storage of the vector, while the transition is in progress
+    for (int i = 1; i < 32; ++i) {
+        transitioners.emplace_back(i);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    REQUIRE(transitioners[0].current_value() == 20);
+    REQUIRE(transitioners[31].current_value() == 31);
+}
+
+TEST_CASE("value_transitioner pushes the latest value at a limited rate") {
+    std::mutex pushed_values_mutex;
+    std::vector<int> pushed_values;
+    value_transitioner<int> transitioner(0);
+
+    transitioner.push_changes_to(
+        [&pushed_values_mutex, &pushed_values](const int &value) {
+            std::lock_guard<std::mutex> pushed_values_guard{pushed_values_mutex};
+            pushed_values.push_back(value);
+        },
+        std::chrono::milliseconds(100));
+    transitioner.start_transition_thread(
+        [](auto time_diff, auto &current_value, const auto &target_value) {
+            if (current_value == target_value) {
+                return transition_state::finished_transition;
+            }
+
+            current_value += current_value < target_value ? 1 : -1;
+            return transition_state::value_did_change;
+        },
+        std::chrono::milliseconds(5));
+    transitioner.target_value(50);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(800));
+
+    std::lock_guard<std::mutex> pushed_values_guard{pushed_values_mutex};
+    REQUIRE(!pushed_values.empty());
+    REQUIRE(pushed_values.back() == 50);
+    // 50 steps within ~250ms, but only one push per 100ms
+    REQUIRE(pushed_values.size() < 10);
+}
+
+TEST_CASE("value_transitioner evaluates transitions when the value is read") {
+    value_transitioner<int> transitioner(0);
+
+    // The steps are too far apart to update the value during the transition
+    transitioner.start_transition_thread(evaluable_transition{}, std::chrono::seconds(10));
+    transitioner.target_value(1000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    auto halfway = transitioner.current_value();
+    REQUIRE(halfway >= 400);
+    REQUIRE(halfway <= 600);
+}
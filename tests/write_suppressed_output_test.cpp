@@ -0,0 +1,120 @@
+#define CATCH_CONFIG_MAIN
+#include "io/outputs/write_suppressed_output.h"
+
+#include <chrono>
+#include <thread>
+
+#include "catch2/catch.hpp"
+
+namespace {
+// Counts the writes, which reach the output
+class counting_output final : public output_interface {
+   public:
+    counting_output(size_t &writes, bool &should_fail) : m_writes(writes), m_should_fail(should_fail) {}
+
+    bool control_output(const output_value &value) override {
+        m_value = value;
+        return write();
+    }
+
+    bool override_with(const output_value &value) override {
+        m_overriden_value = value;
+        return write();
+    }
+
+    bool restore_control() override {
+        m_overriden_value.reset();
+        return write();
+    }
+
+    std::optional<output_value> is_overriden() const override { return m_overriden_value; }
+
+    output_value current_state() const override { return m_overriden_value.value_or(m_value); }
+
+   private:
+    bool write() {
+        ++m_writes;
+        return !m_should_fail;
+    }
+
+    size_t &m_writes;
+    bool &m_should_fail;
+    output_value m_value{switch_output::off};
+    std::optional<output_value> m_overriden_value;
+};
+}  // namespace
+
+TEST_CASE("Unchanged values aren't written") {
+    size_t writes = 0;
+    bool should_fail = false;
+    write_suppressed_output output(std::make_unique<counting_output>(writes, should_fail), std::chrono::minutes(10));
+
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(writes == 1);
+
+    REQUIRE(output.control_output(switch_output::off));
+    REQUIRE(writes == 2);
+
+    REQUIRE(output.override_with(switch_output::on));
+    REQUIRE(output.override_with(switch_output::on));
+    REQUIRE(writes == 3);
+    REQUIRE(output.current_state() == output_value(switch_output::on));
+
+    REQUIRE(output.restore_control());
+    REQUIRE(output.restore_control());
+    REQUIRE(writes == 4);
+    REQUIRE(output.current_state() == output_value(switch_output::off));
+    REQUIRE(output.suppressed_writes() == 3);
+}
+
+TEST_CASE("Failed writes are repeated") {
+    size_t writes = 0;
+    bool should_fail = true;
+    write_suppressed_output output(std::make_unique<counting_output>(writes, should_fail), std::chrono::minutes(10));
+
+    REQUIRE_FALSE(output.control_output(switch_output::on));
+
+    should_fail = false;
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(writes == 2);
+}
+
+TEST_CASE("Values are written again after the resync interval") {
+    using namespace std::chrono_literals;
+
+    size_t writes = 0;
+    bool should_fail = false;
+    write_suppressed_output output(std::make_unique<counting_output>(writes, should_fail), 20ms);
+
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(writes == 1);
+
+    std::this_thread::sleep_for(30ms);
+
+    REQUIRE(output.control_output(switch_output::on));
+    REQUIRE(writes == 2);
+}
+
+TEST_CASE("Batches only pass the changed values to the wrapped outputs") {
+    size_t writes = 0;
+    bool should_fail = false;
+    write_suppressed_output first(std::make_unique<counting_output>(writes, should_fail), std::chrono::minutes(10));
+    write_suppressed_output second(std::make_unique<counting_output>(writes, should_fail), std::chrono::minutes(10));
+
+    REQUIRE(first.control_output(switch_output::on));
+    REQUIRE(second.control_output(switch_output::off));
+    REQUIRE(writes == 2);
+
+    // The second control of the first output has to be written, because the first one changed its value
+    auto results = first.control_outputs({{&first, output_value(switch_output::off)},
+                                          {&second, output_value(switch_output::off)},
+                                          {&first, output_value(switch_output::on)}});
+
+    REQUIRE(results == std::vector<bool>{true, true, true});
+    REQUIRE(writes == 4);
+    REQUIRE(first.current_state() == output_value(switch_output::on));
+    REQUIRE(second.suppressed_writes() == 1);
+}